@@ -0,0 +1,122 @@
+#include "QDataAnalysisExport.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <QImage>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "qcustomplot/qcustomplot.h"
+#include "QDataAnalysisGraph.h"
+#include "qt_convert.h"
+#include "gui_profiler.h"
+
+#include "xo/numerical/bounds.h"
+#include "xo/utility/color.h"
+
+namespace
+{
+	// encodes and writes a rendered image, then makes room for the next one in the pipeline
+	class ImageWriteRunnable : public QRunnable
+	{
+	public:
+		ImageWriteRunnable( QImage image, QString fileName, std::atomic< int >& written, QSemaphore& pending ) :
+			image_( std::move( image ) ), fileName_( std::move( fileName ) ), written_( written ), pending_( pending )
+		{}
+
+		virtual void run() override
+		{
+			if ( image_.save( fileName_ ) )
+				++written_;
+			pending_.release();
+		}
+
+	private:
+		QImage image_;
+		QString fileName_;
+		std::atomic< int >& written_;
+		QSemaphore& pending_;
+	};
+
+	void setupPlot( QCustomPlot& plot, const QDataAnalysisExportJob& job )
+	{
+		plot.clearPlottables();
+		const auto& m = *job.model;
+		auto keys = std::make_shared< QDataAnalysisKeyCache >();
+		for ( int i = 0; i < int( job.channels.size() ); ++i )
+		{
+			auto* graph = new QDataAnalysisGraph( m, job.channels[ i ], plot.xAxis, plot.yAxis, keys );
+			plot.addPlottable( graph );
+			graph->setName( m.label( job.channels[ i ] ) );
+			graph->setPen( QPen( to_qt( xo::make_unique_color( i ) ), job.lineWidth ) );
+		}
+
+		// fit the vertical axis to the visible part of the channels, like QDataAnalysisView
+		double lower = job.timeLower < job.timeUpper ? job.timeLower : m.timeStart();
+		double upper = job.timeLower < job.timeUpper ? job.timeUpper : m.timeFinish();
+		plot.xAxis->setRange( lower, upper );
+		xo::bounds< double > yrange( 0, 0 );
+		for ( int i = 0; i < plot.plottableCount(); ++i )
+		{
+			bool found = false;
+			auto r = static_cast< QDataAnalysisGraph* >( plot.plottable( i ) )->valueRange( m.timeIndex( lower ), m.timeIndex( upper ), found );
+			if ( found )
+			{
+				yrange.extend( r.lower );
+				yrange.extend( r.upper );
+			}
+		}
+
+		// QCPAxis ignores empty ranges, which would keep the range of the previous job
+		if ( yrange.upper <= yrange.lower )
+		{
+			const double margin = yrange.lower != 0 ? std::abs( yrange.lower ) * 0.1 : 1.0;
+			yrange = xo::bounds< double >( yrange.lower - margin, yrange.upper + margin );
+		}
+		plot.yAxis->setRange( yrange.lower, yrange.upper );
+		plot.legend->setVisible( !job.channels.empty() );
+	}
+}
+
+int exportDataAnalysisPlots( const std::vector< QDataAnalysisExportJob >& jobs )
+{
+	GUI_PROFILE_FUNCTION;
+
+	QCustomPlot plot;
+	plot.setPlottingHint( QCP::phParallelRendering, true );
+
+	// at most two images per encoding thread are kept in memory
+	QThreadPool pool;
+	QSemaphore pending( 2 * pool.maxThreadCount() );
+	std::atomic< int > written( 0 );
+
+	for ( const auto& job : jobs )
+	{
+		if ( !job.model || !job.model->hasData() || job.size.isEmpty() )
+			continue;
+
+		setupPlot( plot, job );
+		if ( job.fileName.endsWith( ".pdf", Qt::CaseInsensitive ) )
+		{
+			// vector output can't be rasterized in parallel, it is written directly
+			if ( plot.savePdf( job.fileName, false, job.size.width(), job.size.height() ) )
+				++written;
+		}
+		else
+		{
+			QImage image( job.size, QImage::Format_ARGB32_Premultiplied );
+			image.fill( Qt::white );
+			QCPPainter painter( &image );
+			plot.toPainter( &painter, job.size.width(), job.size.height() );
+			painter.end();
+
+			pending.acquire();
+			pool.start( new ImageWriteRunnable( std::move( image ), job.fileName, written, pending ) );
+		}
+	}
+
+	pool.waitForDone();
+	return written;
+}
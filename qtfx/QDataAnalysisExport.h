@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QSize>
+
+#include "QDataAnalysisModel.h"
+
+// plot of a number of channels of a model, to be written to fileName;
+// the format follows the file extension (e.g. .png, .jpg or .pdf)
+struct QDataAnalysisExportJob
+{
+	const QDataAnalysisModel* model = nullptr;
+	std::vector< int > channels;
+	double timeLower = 0.0; // full time range of the model if timeLower >= timeUpper
+	double timeUpper = 0.0;
+	QSize size = QSize( 800, 600 );
+	float lineWidth = 1.0f;
+	QString fileName;
+};
+
+// renders the jobs into images without showing a widget and writes them to disk; graphs are
+// rasterized in parallel and images are encoded on worker threads while the next job renders;
+// must be called from the GUI thread, returns the number of files that were written
+int exportDataAnalysisPlots( const std::vector< QDataAnalysisExportJob >& jobs );
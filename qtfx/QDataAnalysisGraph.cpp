@@ -0,0 +1,667 @@
+#include "QDataAnalysisGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <QReadWriteLock>
+#include <QRunnable>
+#include <QThreadPool>
+
+// pyramid that is built on a worker thread, shared between the graph and the runnable
+struct QDataAnalysisPyramidTask
+{
+	std::mutex mutex;
+	bool cancelled = false;
+	bool done = false;
+	int frameCount = 0;
+	QDataAnalysisPyramid pyramid;
+};
+
+namespace
+{
+	// fallback accessors for models that don't expose their samples directly
+	struct ModelTimeAccessor
+	{
+		const QDataAnalysisModel& m;
+		double operator[]( int frame ) const { return m.timeValue( frame ); }
+	};
+
+	struct ModelValueAccessor
+	{
+		const QDataAnalysisModel& m;
+		int channel;
+		double operator[]( int frame ) const { return m.value( channel, frame ); }
+	};
+
+	// calls func( keys, values ) with the fastest accessors available for channel
+	template< typename F >
+	void visitChannel( const QDataAnalysisModel& m, int channel, F&& func )
+	{
+		if ( auto tc = m.timeChannel(); tc >= 0 )
+		{
+			if ( auto v = m.floatColumn( channel ) )
+				return func( m.floatColumn( tc ), v );
+			if ( auto v = m.doubleColumn( channel ) )
+				return func( m.doubleColumn( tc ), v );
+		}
+		func( ModelTimeAccessor{ m }, ModelValueAccessor{ m, channel } );
+	}
+
+	// calls func( keys ) with the fastest time accessor available
+	template< typename F >
+	void visitKeys( const QDataAnalysisModel& m, F&& func )
+	{
+		if ( auto tc = m.timeChannel(); tc >= 0 )
+		{
+			if ( auto k = m.floatColumn( tc ) )
+				return func( k );
+			if ( auto k = m.doubleColumn( tc ) )
+				return func( k );
+		}
+		func( ModelTimeAccessor{ m } );
+	}
+
+	// index of first frame with key >= t
+	template< typename K >
+	int lowerFrame( const K& keys, int frameCount, double t )
+	{
+		int lo = 0, hi = frameCount;
+		while ( lo < hi )
+		{
+			int mid = lo + ( hi - lo ) / 2;
+			if ( keys[ mid ] < t )
+				lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	// index of first frame with key > t
+	template< typename K >
+	int upperFrame( const K& keys, int frameCount, double t )
+	{
+		int lo = 0, hi = frameCount;
+		while ( lo < hi )
+		{
+			int mid = lo + ( hi - lo ) / 2;
+			if ( keys[ mid ] <= t )
+				lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	void extendRange( QCPRange& range, bool& foundRange, double v )
+	{
+		if ( !foundRange )
+		{
+			range = QCPRange( v, v );
+			foundRange = true;
+		}
+		else if ( v < range.lower )
+			range.lower = v;
+		else if ( v > range.upper )
+			range.upper = v;
+	}
+
+	// extremes are NaN for blocks without valid samples
+	void extendExtremes( QCPRange& r, double v )
+	{
+		if ( qIsNaN( v ) )
+			return;
+		if ( qIsNaN( r.lower ) )
+			r.lower = r.upper = v;
+		else if ( v < r.lower )
+			r.lower = v;
+		else if ( v > r.upper )
+			r.upper = v;
+	}
+
+	void mergeExtremes( QCPRange& r, const QCPRange& other )
+	{
+		if ( qIsNaN( other.lower ) )
+			return;
+		if ( qIsNaN( r.lower ) )
+			r = other;
+		else
+		{
+			r.lower = std::min( r.lower, other.lower );
+			r.upper = std::max( r.upper, other.upper );
+		}
+	}
+
+	// extremes of a strided subset of frames, used while the pyramid is not available
+	template< typename V >
+	QCPRange sampleExtremes( const V& values, int first, int last, int sampleCount )
+	{
+		QCPRange r( qQNaN(), qQNaN() );
+		if ( last < first )
+			return r;
+		const int step = std::max( ( last - first + 1 ) / sampleCount, 1 );
+		for ( int f = first; f <= last; f += step )
+			extendExtremes( r, values[ f ] );
+		extendExtremes( r, values[ last ] );
+		return r;
+	}
+
+	// builds a pyramid from a private copy of the samples, which is taken on the worker thread
+	// while holding the sample lock of the model, so the storage can't be reallocated meanwhile
+	template< typename T >
+	class PyramidRunnable : public QRunnable
+	{
+	public:
+		PyramidRunnable( std::shared_ptr< QDataAnalysisPyramidTask > task, const QDataAnalysisModel& model, int channel, QObject* graph ) :
+			task_( std::move( task ) ), model_( model ), channel_( channel ), graph_( graph )
+		{}
+
+		virtual void run() override
+		{
+			std::vector< T > values;
+			{
+				// the graph cancels the task under the same lock before it is destroyed,
+				// so the model outlives the copy
+				std::lock_guard< std::mutex > lock( task_->mutex );
+				if ( task_->cancelled )
+					return;
+				QReadLocker samples( &model_.sampleLock() );
+				const auto column = this->column();
+				values.resize( std::min( task_->frameCount, column.size ) );
+				for ( int f = 0; f < int( values.size() ); ++f )
+					values[ f ] = column[ f ];
+			}
+
+			QDataAnalysisPyramid pyramid;
+			pyramid.update( values, int( values.size() ) );
+
+			// the graph cancels the task under the same lock before it is destroyed
+			std::lock_guard< std::mutex > lock( task_->mutex );
+			if ( !task_->cancelled )
+			{
+				task_->pyramid = std::move( pyramid );
+				task_->done = true;
+				QMetaObject::invokeMethod( graph_, "finishPrepare", Qt::QueuedConnection );
+			}
+		}
+
+	private:
+		QDataAnalysisColumn< T > column() const {
+			if constexpr ( std::is_same_v< T, float > ) return model_.floatColumn( channel_ ); else return model_.doubleColumn( channel_ );
+		}
+
+		std::shared_ptr< QDataAnalysisPyramidTask > task_;
+		const QDataAnalysisModel& model_;
+		int channel_;
+		QObject* graph_;
+	};
+
+	void drawPolylineSegments( QCPPainter* painter, const QVector< QPointF >& points )
+	{
+		// NaNs create a gap in the line
+		int segmentStart = 0;
+		for ( int i = 0; i < points.size(); ++i )
+		{
+			if ( qIsNaN( points[ i ].x() ) || qIsNaN( points[ i ].y() ) || qIsInf( points[ i ].y() ) )
+			{
+				if ( i - segmentStart > 1 )
+					painter->drawPolyline( points.constData() + segmentStart, i - segmentStart );
+				segmentStart = i + 1;
+			}
+		}
+		if ( points.size() - segmentStart > 1 )
+			painter->drawPolyline( points.constData() + segmentStart, points.size() - segmentStart );
+	}
+}
+
+template< typename V >
+void QDataAnalysisPyramid::update( const V& values, int frameCount )
+{
+	if ( frameCount < frameCount_ )
+		clear();
+	if ( frameCount == frameCount_ )
+		return;
+
+	// only blocks that contain new frames are recomputed
+	int dirtyBlock = frameCount_ >> baseShift;
+	if ( levels_.empty() )
+		levels_.emplace_back();
+	auto& base = levels_.front();
+	base.resize( ( frameCount + ( 1 << baseShift ) - 1 ) >> baseShift );
+	for ( int b = dirtyBlock; b < int( base.size() ); ++b )
+	{
+		QCPRange r( qQNaN(), qQNaN() );
+		const int end = std::min( ( b + 1 ) << baseShift, frameCount );
+		for ( int f = b << baseShift; f < end; ++f )
+			extendExtremes( r, values[ f ] );
+		base[ b ] = r;
+	}
+
+	// each next level merges pairs of blocks, until a single block remains
+	for ( int l = 1; levels_[ l - 1 ].size() > 1; ++l )
+	{
+		if ( l == int( levels_.size() ) )
+			levels_.emplace_back();
+		const auto& prev = levels_[ l - 1 ];
+		auto& cur = levels_[ l ];
+		dirtyBlock >>= 1;
+		cur.resize( ( prev.size() + 1 ) / 2 );
+		for ( int b = dirtyBlock; b < int( cur.size() ); ++b )
+		{
+			cur[ b ] = prev[ 2 * b ];
+			if ( 2 * b + 1 < int( prev.size() ) )
+				mergeExtremes( cur[ b ], prev[ 2 * b + 1 ] );
+		}
+	}
+
+	frameCount_ = frameCount;
+}
+
+template< typename V >
+QCPRange QDataAnalysisPyramid::extremes( const V& values, int first, int last ) const
+{
+	QCPRange r( qQNaN(), qQNaN() );
+	int lo = std::max( first, 0 );
+	int hi = std::min( last + 1, frameCount_ );
+
+	// frames outside whole blocks are read directly, the last block may be partial
+	const int mask = ( 1 << baseShift ) - 1;
+	while ( lo < hi && ( lo & mask ) != 0 )
+		extendExtremes( r, values[ lo++ ] );
+	while ( lo < hi && ( hi & mask ) != 0 && hi != frameCount_ )
+		extendExtremes( r, values[ --hi ] );
+	if ( lo >= hi )
+		return r;
+
+	// combine at most two blocks per level, bottom-up
+	int blo = lo >> baseShift;
+	int bhi = ( hi + mask ) >> baseShift;
+	for ( int l = 0; blo < bhi; ++l )
+	{
+		const auto& blocks = levels_[ l ];
+		if ( blo & 1 )
+			mergeExtremes( r, blocks[ blo++ ] );
+		if ( bhi & 1 )
+			mergeExtremes( r, blocks[ --bhi ] );
+		blo >>= 1;
+		bhi >>= 1;
+	}
+	return r;
+}
+
+void QDataAnalysisKeyCache::update( const QDataAnalysisModel& m, const QCPAxis* keyAxis )
+{
+	std::lock_guard< std::mutex > lock( mutex_ );
+	const int n = m.frameCount();
+	const auto range = keyAxis->range();
+	const auto rect = keyAxis->axisRect()->rect();
+	if ( valid_ && n == frameCount_ && range.lower == range_.lower && range.upper == range_.upper && rect == rect_
+		&& keyAxis->rangeReversed() == reversed_ && keyAxis->scaleType() == scaleType_ )
+		return;
+
+	valid_ = true;
+	frameCount_ = n;
+	range_ = range;
+	rect_ = rect;
+	reversed_ = keyAxis->rangeReversed();
+	scaleType_ = keyAxis->scaleType();
+	mode_ = noMode;
+	pixels_.clear();
+	columns_.clear();
+	if ( n <= 0 || range.size() <= 0 )
+		return;
+
+	visitKeys( m, [&]( const auto& keys ) {
+		first_ = std::max( lowerFrame( keys, n, range.lower ) - 1, 0 );
+		last_ = std::min( upperFrame( keys, n, range.upper ), n - 1 );
+		const int count = last_ - first_ + 1;
+		const int pixelSpan = int( std::abs( keyAxis->coordToPixel( keys[ last_ ] ) - keyAxis->coordToPixel( keys[ first_ ] ) ) );
+		const int framesPerPixel = count / std::max( pixelSpan, 1 );
+
+		if ( framesPerPixel >= ( 1 << QDataAnalysisPyramid::baseShift ) )
+		{
+			// use the coarsest pyramid level that still has at least one block (two samples) per pixel
+			mode_ = pyramidMode;
+			level_ = 0;
+			while ( ( 2 << ( QDataAnalysisPyramid::baseShift + level_ ) ) <= framesPerPixel )
+				++level_;
+			const int shift = QDataAnalysisPyramid::baseShift + level_;
+			pixels_.reserve( ( last_ >> shift ) - ( first_ >> shift ) + 1 );
+			for ( int b = first_ >> shift; b <= ( last_ >> shift ); ++b )
+				pixels_.push_back( keyAxis->coordToPixel( keys[ b << shift ] ) );
+		}
+		else
+		{
+			pixels_.reserve( count );
+			for ( int f = first_; f <= last_; ++f )
+				pixels_.push_back( keyAxis->coordToPixel( keys[ f ] ) );
+
+			if ( count > 2 * pixelSpan + 2 )
+			{
+				// more than two samples per pixel, store the first frame of each pixel column
+				mode_ = columnMode;
+				for ( int i = 0; i < count; ++i )
+					if ( i == 0 || int( pixels_[ i ] ) != int( pixels_[ i - 1 ] ) )
+						columns_.push_back( first_ + i );
+				columns_.push_back( last_ + 1 );
+			}
+			else mode_ = frameMode;
+		}
+	} );
+}
+
+QDataAnalysisGraph::QDataAnalysisGraph( const QDataAnalysisModel& m, int channel, QCPAxis* keyAxis, QCPAxis* valueAxis,
+	std::shared_ptr< QDataAnalysisKeyCache > keys ) :
+	QCPAbstractPlottable( keyAxis, valueAxis ),
+	model_( m ),
+	channel_( channel ),
+	keys_( keys ? std::move( keys ) : std::make_shared< QDataAnalysisKeyCache >() )
+{
+	setPen( QPen( Qt::blue, 0 ) );
+	setBrush( Qt::NoBrush );
+	setSelectedPen( QPen( QColor( 80, 80, 255 ), 2.5 ) );
+	setSelectedBrush( Qt::NoBrush );
+}
+
+QDataAnalysisGraph::~QDataAnalysisGraph()
+{
+	cancelPrepare();
+}
+
+void QDataAnalysisGraph::invalidate()
+{
+	cancelPrepare();
+	pyramid_.clear();
+	keys_->invalidate();
+	snapshot_.clear();
+}
+
+void QDataAnalysisGraph::prepareAsync()
+{
+	const int n = model_.frameCount();
+	if ( task_ || n < asyncFrameCount || pyramid_.frameCount() == n )
+		return;
+
+	// models without direct column access are indexed on demand
+	auto task = std::make_shared< QDataAnalysisPyramidTask >();
+	task->frameCount = n;
+	if ( model_.floatColumn( channel_ ) )
+		QThreadPool::globalInstance()->start( new PyramidRunnable< float >( task, model_, channel_, this ) );
+	else if ( model_.doubleColumn( channel_ ) )
+		QThreadPool::globalInstance()->start( new PyramidRunnable< double >( task, model_, channel_, this ) );
+	else return;
+	task_ = task;
+}
+
+void QDataAnalysisGraph::finishPrepare()
+{
+	// ignore results of tasks that were cancelled after they finished
+	if ( !task_ )
+		return;
+	{
+		std::lock_guard< std::mutex > lock( task_->mutex );
+		if ( !task_->done )
+			return;
+		pyramid_ = std::move( task_->pyramid );
+	}
+	task_.reset();
+	emit prepared();
+}
+
+void QDataAnalysisGraph::cancelPrepare()
+{
+	if ( task_ )
+	{
+		std::lock_guard< std::mutex > lock( task_->mutex );
+		task_->cancelled = true;
+	}
+	task_.reset();
+}
+
+double QDataAnalysisGraph::selectTest( const QPointF& pos, bool onlySelectable, QVariant* details ) const
+{
+	Q_UNUSED( details )
+	if ( ( onlySelectable && !mSelectable ) || !mKeyAxis || !mValueAxis || model_.frameCount() <= 0 )
+		return -1;
+	if ( !mKeyAxis.data()->axisRect()->rect().contains( pos.toPoint() ) )
+		return -1;
+
+	double key, value;
+	pixelsToCoords( pos, key, value );
+	double distSqr = -1;
+	visitChannel( model_, channel_, [&]( const auto& keys, const auto& values ) {
+		const int n = model_.frameCount();
+		const int f = std::clamp( lowerFrame( keys, n, key ), 1, std::max( n - 1, 1 ) );
+		const auto p1 = toPixels( keys[ f - 1 ], values[ f - 1 ] );
+		if ( n > 1 )
+			distSqr = distSqrToLine( p1, toPixels( keys[ f ], values[ f ] ), pos );
+		else distSqr = QVector2D( p1 - pos ).lengthSquared();
+	} );
+	return distSqr >= 0 ? std::sqrt( distSqr ) : -1;
+}
+
+void QDataAnalysisGraph::draw( QCPPainter* painter )
+{
+	QCPAxis* keyAxis = mKeyAxis.data();
+	QCPAxis* valueAxis = mValueAxis.data();
+	if ( !keyAxis || !valueAxis || keyAxis->range().size() <= 0 || model_.frameCount() <= 0 )
+		return;
+
+	lineData_.clear();
+	bool drawScatters = !scatterStyle_.isNone();
+	keys_->update( model_, keyAxis );
+
+	visitChannel( model_, channel_, [&]( const auto&, const auto& values ) {
+		const int first = keys_->first(), last = keys_->last();
+		if ( keys_->mode() == QDataAnalysisKeyCache::pyramidMode && task_ )
+		{
+			// pyramid is still being built, draw the first sample of each block as a preview
+			drawScatters = false;
+			const int shift = QDataAnalysisPyramid::baseShift + keys_->level();
+			lineData_.reserve( ( last >> shift ) - ( first >> shift ) + 1 );
+			for ( int b = first >> shift; b <= ( last >> shift ); ++b )
+				lineData_.append( pointAt( keys_->blockPixel( b ), values[ b << shift ] ) );
+		}
+		else if ( keys_->mode() == QDataAnalysisKeyCache::pyramidMode )
+		{
+			// many samples per pixel, draw from the pyramid level closest to two samples per pixel
+			drawScatters = false;
+			pyramid_.update( values, model_.frameCount() );
+			addPyramidData( keys_->level(), first, last );
+		}
+		else if ( keys_->mode() == QDataAnalysisKeyCache::columnMode )
+		{
+			// more than two samples per pixel, only draw the extremes of each pixel column
+			drawScatters = false;
+			const auto& columns = keys_->columns();
+			lineData_.reserve( 2 * int( columns.size() ) );
+			for ( size_t c = 0; c + 1 < columns.size(); ++c )
+			{
+				int imin = columns[ c ], imax = columns[ c ];
+				for ( int f = imin + 1; f < columns[ c + 1 ]; ++f )
+				{
+					const double v = values[ f ];
+					if ( v < values[ imin ] || qIsNaN( values[ imin ] ) )
+						imin = f;
+					if ( v > values[ imax ] || qIsNaN( values[ imax ] ) )
+						imax = f;
+				}
+				const int i1 = std::min( imin, imax ), i2 = std::max( imin, imax );
+				lineData_.append( pointAt( keys_->keyPixel( i1 ), values[ i1 ] ) );
+				if ( i2 != i1 )
+					lineData_.append( pointAt( keys_->keyPixel( i2 ), values[ i2 ] ) );
+			}
+		}
+		else if ( keys_->mode() == QDataAnalysisKeyCache::frameMode )
+		{
+			lineData_.reserve( last - first + 1 );
+			for ( int f = first; f <= last; ++f )
+				lineData_.append( pointAt( keys_->keyPixel( f ), values[ f ] ) );
+		}
+	} );
+
+	if ( mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0 )
+	{
+		applyDefaultAntialiasingHint( painter );
+		painter->setPen( mainPen() );
+		painter->setBrush( Qt::NoBrush );
+		drawPolylineSegments( painter, lineData_ );
+	}
+
+	if ( drawScatters )
+	{
+		applyScattersAntialiasingHint( painter );
+		scatterStyle_.applyTo( painter, mPen );
+		scatterStyle_.drawShapes( painter, lineData_ );
+	}
+}
+
+void QDataAnalysisGraph::drawLegendIcon( QCPPainter* painter, const QRectF& rect ) const
+{
+	applyDefaultAntialiasingHint( painter );
+	painter->setPen( mPen );
+	painter->drawLine( QLineF( rect.left(), rect.top() + rect.height() / 2.0, rect.right() + 5, rect.top() + rect.height() / 2.0 ) );
+	if ( !scatterStyle_.isNone() && scatterStyle_.shape() != QCPScatterStyle::ssPixmap )
+	{
+		applyScattersAntialiasingHint( painter );
+		scatterStyle_.applyTo( painter, mPen );
+		scatterStyle_.drawShape( painter, QRectF( rect ).center() );
+	}
+}
+
+QCPRange QDataAnalysisGraph::valueRange( int firstFrame, int lastFrame, bool& foundRange ) const
+{
+	QCPRange range;
+	visitChannel( model_, channel_, [&]( const auto&, const auto& values ) {
+		if ( task_ )
+			range = sampleExtremes( values, std::max( firstFrame, 0 ), std::min( lastFrame, model_.frameCount() - 1 ), previewSampleCount );
+		else
+		{
+			pyramid_.update( values, model_.frameCount() );
+			range = pyramid_.extremes( values, firstFrame, lastFrame );
+		}
+	} );
+	foundRange = !qIsNaN( range.lower );
+	return range;
+}
+
+const QCPCompactDataMap& QDataAnalysisGraph::snapshot() const
+{
+	const int n = model_.frameCount();
+	if ( snapshot_.size() > n )
+		snapshot_.clear();
+	if ( const int first = snapshot_.size(); first < n )
+	{
+		visitChannel( model_, channel_, [&]( const auto& keys, const auto& values ) {
+			snapshot_.reserve( n );
+			for ( int f = first; f < n; ++f )
+				snapshot_.insertMulti( keys[ f ], QCPCompactData( keys[ f ], values[ f ] ) );
+		} );
+	}
+	return snapshot_;
+}
+
+QCPRange QDataAnalysisGraph::getKeyRange( bool& foundRange, SignDomain inSignDomain ) const
+{
+	QCPRange range;
+	foundRange = false;
+	visitChannel( model_, channel_, [&]( const auto& keys, const auto& /* values */ ) {
+		const int n = model_.frameCount();
+		if ( inSignDomain == sdBoth )
+		{
+			// keys are sorted, so the range spans the first and last key that are not NaN
+			int first = 0, last = n - 1;
+			while ( first < n && qIsNaN( double( keys[ first ] ) ) )
+				++first;
+			while ( last > first && qIsNaN( double( keys[ last ] ) ) )
+				--last;
+			if ( first < n )
+			{
+				range = QCPRange( keys[ first ], keys[ last ] );
+				foundRange = true;
+			}
+			return;
+		}
+		for ( int f = 0; f < n; ++f )
+		{
+			const double k = keys[ f ];
+			if ( qIsNaN( k ) || ( inSignDomain == sdNegative && k >= 0 ) || ( inSignDomain == sdPositive && k <= 0 ) )
+				continue;
+			extendRange( range, foundRange, k );
+		}
+	} );
+	return range;
+}
+
+QCPRange QDataAnalysisGraph::getValueRange( bool& foundRange, SignDomain inSignDomain ) const
+{
+	QCPRange range;
+	foundRange = false;
+	visitChannel( model_, channel_, [&]( const auto& keys, const auto& values ) {
+		const int n = model_.frameCount();
+		if ( inSignDomain == sdBoth && task_ )
+		{
+			range = sampleExtremes( values, 0, n - 1, previewSampleCount );
+			foundRange = !qIsNaN( range.lower );
+			return;
+		}
+		else if ( inSignDomain == sdBoth )
+		{
+			// the top level of the pyramid holds the extremes of the entire channel
+			pyramid_.update( values, n );
+			if ( pyramid_.levelCount() > 0 && !qIsNaN( pyramid_.level( pyramid_.levelCount() - 1 ).front().lower ) )
+			{
+				range = pyramid_.level( pyramid_.levelCount() - 1 ).front();
+				foundRange = true;
+			}
+			return;
+		}
+		for ( int f = 0; f < n; ++f )
+		{
+			const double v = values[ f ];
+			if ( qIsNaN( v ) || ( inSignDomain == sdNegative && v >= 0 ) || ( inSignDomain == sdPositive && v <= 0 ) )
+				continue;
+			extendRange( range, foundRange, v );
+		}
+	} );
+	return range;
+}
+
+QPointF QDataAnalysisGraph::toPixels( double key, double value ) const
+{
+	if ( mKeyAxis.data()->orientation() == Qt::Vertical )
+		return QPointF( mValueAxis.data()->coordToPixel( value ), mKeyAxis.data()->coordToPixel( key ) );
+	else return QPointF( mKeyAxis.data()->coordToPixel( key ), mValueAxis.data()->coordToPixel( value ) );
+}
+
+QPointF QDataAnalysisGraph::pointAt( double keyPixel, double value ) const
+{
+	const double valuePixel = mValueAxis.data()->coordToPixel( value );
+	if ( mKeyAxis.data()->orientation() == Qt::Vertical )
+		return QPointF( valuePixel, keyPixel );
+	else return QPointF( keyPixel, valuePixel );
+}
+
+void QDataAnalysisGraph::addPyramidData( int level, int first, int last )
+{
+	const int shift = pyramid_.blockShift( level );
+	const auto& blocks = pyramid_.level( level );
+	lineData_.reserve( 2 * ( ( last >> shift ) - ( first >> shift ) + 1 ) );
+	for ( int b = first >> shift; b <= ( last >> shift ); ++b )
+	{
+		const auto& r = blocks[ b ];
+		if ( qIsNaN( r.lower ) )
+		{
+			lineData_.append( QPointF( qQNaN(), qQNaN() ) );
+			continue;
+		}
+
+		// connect to whichever extreme is closest to the previous point
+		const double keyPixel = keys_->blockPixel( b );
+		auto p1 = pointAt( keyPixel, r.lower );
+		auto p2 = pointAt( keyPixel, r.upper );
+		if ( !lineData_.isEmpty() && ( lineData_.back() - p2 ).manhattanLength() < ( lineData_.back() - p1 ).manhattanLength() )
+			std::swap( p1, p2 );
+		lineData_.append( p1 );
+		if ( p2 != p1 )
+			lineData_.append( p2 );
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "qcustomplot/qcustomplot.h"
+#include "QDataAnalysisModel.h"
+
+// multi-resolution min / max index of a channel, built lazily and extended when frames are appended
+class QDataAnalysisPyramid
+{
+public:
+	// level 0 holds the extremes of blocks of 2^baseShift frames, each next level halves the resolution
+	static constexpr int baseShift = 4;
+
+	template< typename V > void update( const V& values, int frameCount );
+	template< typename V > QCPRange extremes( const V& values, int first, int last ) const;
+	void clear() { levels_.clear(); frameCount_ = 0; }
+
+	int frameCount() const { return frameCount_; }
+	int levelCount() const { return int( levels_.size() ); }
+	int blockShift( int level ) const { return baseShift + level; }
+	const std::vector< QCPRange >& level( int l ) const { return levels_[ l ]; }
+
+private:
+	std::vector< std::vector< QCPRange > > levels_;
+	int frameCount_ = 0;
+};
+
+// pixel positions of the time channel inside the visible key range; these are the same for
+// all channels of a model, so graphs that share a cache only compute them once per replot
+// (graphs may be drawn concurrently, so updates are serialized)
+class QDataAnalysisKeyCache
+{
+public:
+	enum Mode { noMode, pyramidMode, columnMode, frameMode };
+
+	void update( const QDataAnalysisModel& m, const QCPAxis* keyAxis );
+	void invalidate() { valid_ = false; }
+
+	Mode mode() const { return mode_; }
+	int first() const { return first_; }
+	int last() const { return last_; }
+	int level() const { return level_; }
+	double keyPixel( int frame ) const { return pixels_[ frame - first_ ]; }
+	double blockPixel( int block ) const { return pixels_[ block - ( first_ >> ( QDataAnalysisPyramid::baseShift + level_ ) ) ]; }
+	const std::vector< int >& columns() const { return columns_; }
+
+private:
+	std::mutex mutex_;
+	bool valid_ = false;
+	int frameCount_ = 0;
+	QCPRange range_;
+	QRect rect_;
+	bool reversed_ = false;
+	QCPAxis::ScaleType scaleType_ = QCPAxis::stLinear;
+
+	Mode mode_ = noMode;
+	int first_ = 0;
+	int last_ = -1;
+	int level_ = -1;
+	std::vector< double > pixels_;
+	std::vector< int > columns_;
+};
+
+struct QDataAnalysisPyramidTask;
+
+// plottable that draws a single channel of a QDataAnalysisModel, reading the samples
+// directly from the model instead of copying them into a QCPDataMap
+class QDataAnalysisGraph : public QCPAbstractPlottable
+{
+	Q_OBJECT
+
+public:
+	QDataAnalysisGraph( const QDataAnalysisModel& m, int channel, QCPAxis* keyAxis, QCPAxis* valueAxis,
+		std::shared_ptr< QDataAnalysisKeyCache > keys = nullptr );
+	virtual ~QDataAnalysisGraph();
+
+	int channel() const { return channel_; }
+	const QCPScatterStyle& scatterStyle() const { return scatterStyle_; }
+	void setScatterStyle( const QCPScatterStyle& style ) { scatterStyle_ = style; }
+	void invalidate();
+	QCPRange valueRange( int firstFrame, int lastFrame, bool& foundRange ) const;
+
+	// samples of the channel in single precision, which copies share until either is modified;
+	// built on first use and extended with frames that were appended since
+	const QCPCompactDataMap& snapshot() const;
+
+	// builds the pyramid of large channels on the global thread pool and emits prepared() when done;
+	// until then, a strided preview is drawn and value ranges are estimated
+	void prepareAsync();
+	bool isPrepared() const { return !task_; }
+
+	virtual void clearData() override {}
+	virtual double selectTest( const QPointF& pos, bool onlySelectable, QVariant* details = 0 ) const override;
+
+signals:
+	void prepared();
+
+protected:
+	virtual void draw( QCPPainter* painter ) override;
+	virtual void drawLegendIcon( QCPPainter* painter, const QRectF& rect ) const override;
+	virtual QCPRange getKeyRange( bool& foundRange, SignDomain inSignDomain = sdBoth ) const override;
+	virtual QCPRange getValueRange( bool& foundRange, SignDomain inSignDomain = sdBoth ) const override;
+
+private slots:
+	void finishPrepare();
+
+private:
+	static constexpr int asyncFrameCount = 1 << 16;
+	static constexpr int previewSampleCount = 4096;
+
+	void cancelPrepare();
+	QPointF toPixels( double key, double value ) const;
+	QPointF pointAt( double keyPixel, double value ) const;
+	void addPyramidData( int level, int first, int last );
+
+	const QDataAnalysisModel& model_;
+	int channel_;
+	std::shared_ptr< QDataAnalysisKeyCache > keys_;
+	QCPScatterStyle scatterStyle_;
+	mutable QDataAnalysisPyramid pyramid_;
+	std::shared_ptr< QDataAnalysisPyramidTask > task_;
+	QVector< QPointF > lineData_;
+	mutable QCPCompactDataMap snapshot_;
+};
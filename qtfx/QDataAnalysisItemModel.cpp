@@ -0,0 +1,327 @@
+#include "QDataAnalysisItemModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <numeric>
+#include <QRegExp>
+
+static int decimalPoints( double v )
+{
+	if ( v != 0 && std::abs( v ) < 0.1 )
+		return 6;
+	else return 3;
+}
+
+// formats with to_chars into a scratch buffer; the text of a visible row is shared with the view,
+// so a changed value always needs a new string
+static QString formatValue( double v )
+{
+	char buf[ 32 ];
+	auto [ end, ec ] = std::to_chars( buf, buf + sizeof( buf ), v, std::chars_format::fixed, decimalPoints( v ) );
+	if ( ec == std::errc() )
+		return QString::fromLatin1( buf, int( end - buf ) );
+	else return QString::number( v, 'g', 6 );
+}
+
+static bool isSameValue( double a, double b )
+{
+	return a == b || ( std::isnan( a ) && std::isnan( b ) );
+}
+
+static bool isWildcard( QChar c )
+{
+	return c == '*' || c == '?' || c == '[';
+}
+
+static bool isPlainFilter( const QString& filter )
+{
+	return std::none_of( filter.begin(), filter.end(), isWildcard );
+}
+
+// longest part of a (wildcard) filter that must appear literally in every match
+static QString longestLiteral( const QString& filter )
+{
+	QStringRef longest;
+	int start = 0;
+	for ( int i = 0; i <= filter.size(); ++i )
+	{
+		if ( i == filter.size() || isWildcard( filter[ i ] ) )
+		{
+			if ( i - start > longest.size() )
+				longest = filter.midRef( start, i - start );
+			if ( i < filter.size() && filter[ i ] == '[' )
+				while ( i < filter.size() && filter[ i ] != ']' )
+					++i;
+			start = i + 1;
+		}
+	}
+	return longest.toString();
+}
+
+static quint64 trigramKey( const QChar* c )
+{
+	return ( quint64( c[ 0 ].unicode() ) << 32 ) | ( quint64( c[ 1 ].unicode() ) << 16 ) | quint64( c[ 2 ].unicode() );
+}
+
+QDataAnalysisItemModel::QDataAnalysisItemModel( const QDataAnalysisModel& m, QObject* parent ) :
+	QAbstractItemModel( parent ),
+	model_( m ),
+	filter_(),
+	rows_(),
+	checked_(),
+	frame_( 0 )
+{}
+
+void QDataAnalysisItemModel::reset()
+{
+	beginResetModel();
+	labels_.clear();
+	labels_.reserve( model_.channelCount() );
+	for ( int i = 0; i < model_.channelCount(); ++i )
+		labels_.push_back( model_.label( i ) );
+	trigrams_.clear();
+	checked_ = QBitArray( model_.channelCount() );
+	frame_ = 0;
+	values_.assign( model_.channelCount(), CachedValue() );
+	rows_ = findRows( filter_, nullptr );
+	endResetModel();
+}
+
+void QDataAnalysisItemModel::setFilter( const QString& filter )
+{
+	if ( filter == filter_ )
+		return;
+
+	// a plain filter that contains the previous one only matches a subset of its rows
+	beginResetModel();
+	bool narrow = isPlainFilter( filter ) && isPlainFilter( filter_ ) && filter.contains( filter_ );
+	rows_ = findRows( filter, narrow ? &rows_ : nullptr );
+	filter_ = filter;
+	endResetModel();
+}
+
+void QDataAnalysisItemModel::setTime( double time, int firstRow, int lastRow )
+{
+	if ( !model_.hasData() )
+		return;
+
+	frame_ = model_.timeIndex( time );
+	firstRow = std::max( firstRow, 0 );
+	lastRow = std::min( lastRow, int( rows_.size() ) - 1 );
+	if ( firstRow > lastRow || frame_ >= model_.frameCount() )
+		return;
+
+	// rows_ is contiguous, so the visible channels can be fetched in a single call
+	const int count = lastRow - firstRow + 1;
+	valueBuffer_.resize( count );
+	model_.frameValues( frame_, rows_.data() + firstRow, count, valueBuffer_.data() );
+
+	// only rows whose value differs from what is displayed are formatted and signaled
+	int changedRow = -1;
+	for ( int i = 0; i <= count; ++i )
+	{
+		bool changed = false;
+		if ( i < count )
+		{
+			auto& cv = values_[ rows_[ firstRow + i ] ];
+			changed = cv.frame < 0 || !isSameValue( cv.value, valueBuffer_[ i ] );
+			if ( changed )
+			{
+				cv.value = valueBuffer_[ i ];
+				cv.text = formatValue( cv.value );
+			}
+			cv.frame = frame_;
+		}
+
+		if ( changed && changedRow < 0 )
+			changedRow = firstRow + i;
+		else if ( !changed && changedRow >= 0 )
+		{
+			emit dataChanged( index( changedRow, 1 ), index( firstRow + i - 1, 1 ), { Qt::DisplayRole } );
+			changedRow = -1;
+		}
+	}
+}
+
+const QString& QDataAnalysisItemModel::valueText( int channel ) const
+{
+	// rows that were not visible during setTime are refreshed when they are shown
+	auto& cv = values_[ channel ];
+	if ( cv.frame != frame_ )
+	{
+		auto y = model_.value( channel, frame_ );
+		if ( cv.frame < 0 || !isSameValue( cv.value, y ) )
+		{
+			cv.value = y;
+			cv.text = formatValue( y );
+		}
+		cv.frame = frame_;
+	}
+	return cv.text;
+}
+
+int QDataAnalysisItemModel::row( int channel ) const
+{
+	auto it = std::lower_bound( rows_.begin(), rows_.end(), channel );
+	return it != rows_.end() && *it == channel ? int( it - rows_.begin() ) : -1;
+}
+
+void QDataAnalysisItemModel::setChecked( int channel, bool checked )
+{
+	if ( checked_.testBit( channel ) != checked )
+	{
+		checked_.setBit( channel, checked );
+		if ( auto r = row( channel ); r >= 0 )
+			emit dataChanged( index( r, 0 ), index( r, 0 ), { Qt::CheckStateRole } );
+	}
+}
+
+int QDataAnalysisItemModel::checkedRowCount() const
+{
+	return int( std::count_if( rows_.begin(), rows_.end(), [&]( int c ) { return checked_.testBit( c ); } ) );
+}
+
+QModelIndex QDataAnalysisItemModel::index( int row, int column, const QModelIndex& parent ) const
+{
+	if ( parent.isValid() || row < 0 || row >= int( rows_.size() ) || column < 0 || column >= 2 )
+		return QModelIndex();
+	else return createIndex( row, column );
+}
+
+QModelIndex QDataAnalysisItemModel::parent( const QModelIndex& child ) const
+{
+	return QModelIndex();
+}
+
+int QDataAnalysisItemModel::rowCount( const QModelIndex& parent ) const
+{
+	return parent.isValid() ? 0 : int( rows_.size() );
+}
+
+int QDataAnalysisItemModel::columnCount( const QModelIndex& parent ) const
+{
+	return 2;
+}
+
+QVariant QDataAnalysisItemModel::data( const QModelIndex& index, int role ) const
+{
+	if ( !index.isValid() )
+		return QVariant();
+
+	const int channel = rows_[ index.row() ];
+	if ( index.column() == 0 )
+	{
+		if ( role == Qt::DisplayRole )
+			return labels_[ channel ];
+		else if ( role == Qt::CheckStateRole )
+			return checked_.testBit( channel ) ? Qt::Checked : Qt::Unchecked;
+	}
+	else
+	{
+		if ( role == Qt::DisplayRole && frame_ < model_.frameCount() )
+			return valueText( channel );
+		else if ( role == Qt::TextAlignmentRole )
+			return int( Qt::AlignRight | Qt::AlignVCenter );
+	}
+	return QVariant();
+}
+
+bool QDataAnalysisItemModel::setData( const QModelIndex& index, const QVariant& value, int role )
+{
+	if ( index.isValid() && index.column() == 0 && role == Qt::CheckStateRole )
+	{
+		setChecked( rows_[ index.row() ], value.toInt() == Qt::Checked );
+		return true;
+	}
+	else return false;
+}
+
+Qt::ItemFlags QDataAnalysisItemModel::flags( const QModelIndex& index ) const
+{
+	if ( !index.isValid() )
+		return 0;
+	else if ( index.column() == 0 )
+		return Qt::ItemIsUserCheckable | QAbstractItemModel::flags( index );
+	else return QAbstractItemModel::flags( index );
+}
+
+QVariant QDataAnalysisItemModel::headerData( int section, Qt::Orientation orientation, int role ) const
+{
+	static const QStringList column_names = { "Variable", "Value" };
+	if ( role == Qt::DisplayRole && orientation == Qt::Horizontal )
+		return column_names[ section ];
+	else return QVariant();
+}
+
+std::vector< int > QDataAnalysisItemModel::findRows( const QString& filter, const std::vector< int >* candidates )
+{
+	std::vector< int > all;
+	if ( !candidates )
+	{
+		if ( auto fragment = longestLiteral( filter ); fragment.size() >= 3 )
+			all = findTrigramCandidates( fragment );
+		else
+		{
+			all.resize( labels_.size() );
+			std::iota( all.begin(), all.end(), 0 );
+		}
+		candidates = &all;
+	}
+
+	std::vector< int > result;
+	if ( isPlainFilter( filter ) )
+	{
+		for ( int c : *candidates )
+			if ( labels_[ c ].contains( filter ) )
+				result.push_back( c );
+	}
+	else
+	{
+		auto regexp = QRegExp( filter, Qt::CaseSensitive, QRegExp::Wildcard );
+		for ( int c : *candidates )
+			if ( labels_[ c ].contains( filter ) || regexp.exactMatch( labels_[ c ] ) )
+				result.push_back( c );
+	}
+	return result;
+}
+
+std::vector< int > QDataAnalysisItemModel::findTrigramCandidates( const QString& fragment )
+{
+	if ( trigrams_.empty() )
+		buildTrigramIndex();
+
+	// intersect the channel lists of all trigrams, starting with the shortest
+	std::vector< const std::vector< int >* > lists;
+	for ( int i = 0; i + 2 < fragment.size(); ++i )
+	{
+		auto it = trigrams_.find( trigramKey( fragment.constData() + i ) );
+		if ( it == trigrams_.end() )
+			return {};
+		lists.push_back( &it->second );
+	}
+	std::sort( lists.begin(), lists.end(), []( auto* a, auto* b ) { return a->size() < b->size(); } );
+
+	std::vector< int > result = *lists.front(), buffer;
+	for ( size_t i = 1; i < lists.size() && !result.empty(); ++i )
+	{
+		buffer.clear();
+		std::set_intersection( result.begin(), result.end(), lists[ i ]->begin(), lists[ i ]->end(), std::back_inserter( buffer ) );
+		result.swap( buffer );
+	}
+	return result;
+}
+
+void QDataAnalysisItemModel::buildTrigramIndex()
+{
+	for ( int c = 0; c < int( labels_.size() ); ++c )
+	{
+		const auto& s = labels_[ c ];
+		for ( int i = 0; i + 2 < s.size(); ++i )
+		{
+			auto& channels = trigrams_[ trigramKey( s.constData() + i ) ];
+			if ( channels.empty() || channels.back() != c )
+				channels.push_back( c );
+		}
+	}
+}
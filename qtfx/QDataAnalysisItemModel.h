@@ -0,0 +1,61 @@
+#pragma once
+
+#include "QAbstractItemModel"
+#include <QBitArray>
+#include <vector>
+#include <unordered_map>
+
+#include "QDataAnalysisModel.h"
+
+// flat list of the channels of a QDataAnalysisModel that pass the filter, with check state and
+// the value at the current time; values are only formatted for rows that are actually shown,
+// and only when they differ from the previously displayed value
+class QDataAnalysisItemModel : public QAbstractItemModel
+{
+public:
+	QDataAnalysisItemModel( const QDataAnalysisModel& m, QObject* parent = nullptr );
+	virtual ~QDataAnalysisItemModel() = default;
+
+	void reset();
+	void setFilter( const QString& filter );
+	void setTime( double time, int firstRow, int lastRow );
+
+	int channelCount() const { return checked_.size(); }
+	int channel( int row ) const { return rows_[ row ]; }
+	const QString& label( int channel ) const { return labels_[ channel ]; }
+	int row( int channel ) const;
+	bool isChecked( int channel ) const { return checked_.testBit( channel ); }
+	void setChecked( int channel, bool checked );
+	int checkedRowCount() const;
+
+	virtual QModelIndex index( int row, int column, const QModelIndex& parent = QModelIndex() ) const override;
+	virtual QModelIndex parent( const QModelIndex& child ) const override;
+	virtual int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
+	virtual int columnCount( const QModelIndex& parent = QModelIndex() ) const override;
+	virtual QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const override;
+	virtual bool setData( const QModelIndex& index, const QVariant& value, int role = Qt::EditRole ) override;
+	virtual Qt::ItemFlags flags( const QModelIndex& index ) const override;
+	virtual QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const override;
+
+private:
+	std::vector< int > findRows( const QString& filter, const std::vector< int >* candidates );
+	std::vector< int > findTrigramCandidates( const QString& fragment );
+	void buildTrigramIndex();
+	const QString& valueText( int channel ) const;
+
+	struct CachedValue {
+		int frame = -1;
+		double value = 0.0;
+		QString text;
+	};
+
+	const QDataAnalysisModel& model_;
+	QString filter_;
+	std::vector< int > rows_;
+	std::vector< QString > labels_;
+	std::unordered_map< quint64, std::vector< int > > trigrams_;
+	QBitArray checked_;
+	int frame_;
+	mutable std::vector< CachedValue > values_;
+	std::vector< double > valueBuffer_;
+};
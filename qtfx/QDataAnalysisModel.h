@@ -2,12 +2,27 @@
 
 #include <vector>
 #include <utility>
+#include <type_traits>
+#include <cstddef>
 
+#include <QReadWriteLock>
 #include <QString>
 
 #include "xo/container/storage_tools.h"
 #include "xo/xo_types.h"
 
+// strided read-only view on the samples of a single channel, indexed by frame
+template< typename T >
+struct QDataAnalysisColumn
+{
+	const T* data = nullptr;
+	int stride = 0;
+	int size = 0;
+
+	explicit operator bool() const { return data != nullptr; }
+	T operator[]( int frame ) const { return data[ ptrdiff_t( frame ) * stride ]; }
+};
+
 class QDataAnalysisModel
 {
 public:
@@ -29,7 +44,35 @@ public:
 	virtual int timeIndex( double time ) const = 0;
 	virtual double timeValue( int frame ) const = 0;
 
+	// batch access, writes count values of channel (or time) starting at frame first to out
+	virtual void values( int channel, int first, int count, double* out ) const {
+		for ( int i = 0; i < count; ++i )
+			out[ i ] = value( channel, first + i );
+	}
+	virtual void timeValues( int first, int count, double* out ) const {
+		for ( int i = 0; i < count; ++i )
+			out[ i ] = timeValue( first + i );
+	}
+
+	// batch access, writes the values of count channels at frame to out[ i * stride ]
+	virtual void frameValues( int frame, const int* channels, int count, double* out, int stride = 1 ) const {
+		for ( int i = 0; i < count; ++i )
+			out[ i * stride ] = value( channels[ i ], frame );
+	}
+
+	// direct access to channel samples, for models that keep them in memory
+	virtual int timeChannel() const { return -1; }
+	virtual QDataAnalysisColumn< float > floatColumn( int channel ) const { return {}; }
+	virtual QDataAnalysisColumn< double > doubleColumn( int channel ) const { return {}; }
+
 	bool hasData() const { return channelCount() > 0; }
+
+	// held for reading while columns are copied on worker threads; owners of the samples must
+	// hold it for writing while they reallocate or free them, e.g. when appending frames
+	QReadWriteLock& sampleLock() const { return sampleLock_; }
+
+private:
+	mutable QReadWriteLock sampleLock_;
 };
 
 template< typename T >
@@ -37,9 +80,10 @@ class StorageDataAnalysisModel : public QDataAnalysisModel
 {
 public:
 	StorageDataAnalysisModel( const xo::storage< T >* s = nullptr ) : sto_( s ) {}
-	void setStorage( const xo::storage< T >* s ) { sto_ = s; }
+	void setStorage( const xo::storage< T >* s ) { QWriteLocker lock( &sampleLock() ); sto_ = s; }
 
 	virtual int channelCount() const override { return sto_->empty() ? 0 : sto_->channel_size(); }
+	virtual int frameCount() const override { return int( sto_->frame_size() ); }
 	virtual QString label( int idx ) const override { return QString( sto_->get_label( idx ).c_str() ); }
 	virtual double value( int channel, double time ) const override { return ( *sto_ )( timeIndex( time ), channel ); }
 	virtual double value( int channel, int frame ) const override { return ( *sto_ )( frame, channel ); }
@@ -50,7 +94,32 @@ public:
 	virtual int timeIndex( double time ) const override { return xo::find_frame_index( *sto_, float( time ), 0 ); }
 	virtual double timeValue( int idx ) const override { return ( *sto_ )( idx, 0 ); }
 
+	virtual void values( int channel, int first, int count, double* out ) const override {
+		const auto col = column( channel );
+		for ( int i = 0; i < count; ++i )
+			out[ i ] = col[ first + i ];
+	}
+	virtual void timeValues( int first, int count, double* out ) const override { values( 0, first, count, out ); }
+	virtual void frameValues( int frame, const int* channels, int count, double* out, int stride = 1 ) const override {
+		const T* row = &( *sto_ )( frame, 0 );
+		for ( int i = 0; i < count; ++i )
+			out[ i * stride ] = row[ channels[ i ] ];
+	}
+
+	virtual int timeChannel() const override { return 0; }
+	virtual QDataAnalysisColumn< float > floatColumn( int channel ) const override {
+		if constexpr ( std::is_same_v< T, float > ) return column( channel ); else return {};
+	}
+	virtual QDataAnalysisColumn< double > doubleColumn( int channel ) const override {
+		if constexpr ( std::is_same_v< T, double > ) return column( channel ); else return {};
+	}
+
 private:
+	QDataAnalysisColumn< T > column( int channel ) const {
+		if ( sto_->empty() ) return {};
+		return { &( *sto_ )( 0, channel ), int( sto_->channel_size() ), int( sto_->frame_size() ) };
+	}
+
 	const xo::storage< T >* sto_;
 };
 
@@ -3,8 +3,10 @@
 #include <algorithm>
 
 #include "qcustomplot/qcustomplot.h"
+#include "QDataAnalysisGraph.h"
 #include "QAction"
 #include "QHeaderView"
+#include "QTimer"
 #include "qtfx.h"
 #include "qt_convert.h"
 #include "gui_profiler.h"
@@ -21,7 +23,6 @@
 
 QDataAnalysisView::QDataAnalysisView( QDataAnalysisModel& m, QWidget* parent ) :
 	QWidget( parent ),
-	currentUpdateIdx( 0 ),
 	model( m )
 {
 	GUI_PROFILE_FUNCTION;
@@ -36,14 +37,13 @@ QDataAnalysisView::QDataAnalysisView( QDataAnalysisModel& m, QWidget* parent ) :
 	filterGroup = new QHGroup( this, 0, 4 );
 	*filterGroup << filter << selectBox;
 
-	itemList = new QTreeWidget( this );
+	itemModel = new QDataAnalysisItemModel( model, this );
+	itemList = new QTreeView( this );
+	itemList->setModel( itemModel );
 	itemList->setRootIsDecorated( false );
-	itemList->setColumnCount( 2 );
+	itemList->setUniformRowHeights( true );
 	itemList->header()->close();
 	itemList->resize( 100, 100 );
-	QStringList headerLabels;
-	headerLabels << "Variable" << "Value";
-	itemList->setHeaderLabels( headerLabels );
 
 	keepButton = new QPushButton( "&Keep Selected Graphs", this );
 	connect( keepButton, &QPushButton::clicked, this, &QDataAnalysisView::holdSeries );
@@ -51,7 +51,7 @@ QDataAnalysisView::QDataAnalysisView( QDataAnalysisModel& m, QWidget* parent ) :
 	itemGroup = new QVGroup( this, 0, 4 );
 	itemGroup->setContentsMargins( 0, 0, 0, 0 );
 	*itemGroup << filterGroup << itemList << keepButton;
-	connect( itemList, &QTreeWidget::itemChanged, this, &QDataAnalysisView::itemChanged );
+	connect( itemModel, &QAbstractItemModel::dataChanged, this, &QDataAnalysisView::itemDataChanged );
 
 	splitter = new QSplitter( this );
 	splitter->setContentsMargins( 0, 0, 0, 0 );
@@ -64,21 +64,27 @@ QDataAnalysisView::QDataAnalysisView( QDataAnalysisModel& m, QWidget* parent ) :
 	layout->setSpacing( 4 );
 	layout->addWidget( splitter );
 
-	for ( int i = 0; i < maxSeriesCount; ++i )
-		freeColors.insert( i );
+	// all graphs share the same time channel, so their key pixels are computed once per replot
+	keyCache = std::make_shared< QDataAnalysisKeyCache >();
 
 	customPlot = new QCustomPlot();
 	customPlot->setInteraction( QCP::iRangeZoom, true );
 	customPlot->setInteraction( QCP::iRangeDrag, true );
+	customPlot->setPlottingHint( QCP::phParallelRendering, true );
 	customPlot->axisRect()->setRangeDrag( Qt::Horizontal );
 	customPlot->axisRect()->setRangeZoom( Qt::Horizontal );
 	customPlot->legend->setVisible( true );
 	customPlot->legend->setFont( itemList->font() );
 	customPlot->legend->setRowSpacing( -6 );
+
+	// the time cursor has its own buffered layer, so it can move without redrawing the graphs
+	customPlot->addLayer( "cursor", customPlot->layer( "main" ), QCustomPlot::limAbove );
+	customPlot->layer( "cursor" )->setMode( QCPLayer::lmBuffered );
 	customPlotLine = new QCPItemLine( customPlot );
 	customPlotLine->setHead( QCPLineEnding( QCPLineEnding::esDiamond, 9, 9, true ) );
 	customPlotLine->setTail( QCPLineEnding( QCPLineEnding::esDiamond, 9, 9, true ) );
 	customPlot->addItem( customPlotLine );
+	customPlotLine->setLayer( "cursor" );
 	splitter->addWidget( customPlot );
 	connect( customPlot, &QCustomPlot::mousePress, this, &QDataAnalysisView::mouseEvent );
 	connect( customPlot, &QCustomPlot::mouseMove, this, &QDataAnalysisView::mouseEvent );
@@ -89,20 +95,18 @@ QDataAnalysisView::QDataAnalysisView( QDataAnalysisModel& m, QWidget* parent ) :
 	reloadData();
 }
 
-int QDataAnalysisView::decimalPoints( double v )
-{
-	if ( v != 0 && abs( v ) < 0.1 )
-		return 6;
-	else return 3;
-}
-
 void QDataAnalysisView::setTime( double time, bool refreshAll )
 {
 	GUI_PROFILE_FUNCTION;
 
-	if ( itemList->topLevelItemCount() != model.channelCount() )
+	if ( itemModel->channelCount() != model.channelCount() )
 		return reloadData();
 
+	if ( model.frameCount() < frameCount )
+		framesRemoved();
+	else if ( model.frameCount() > frameCount )
+		framesAppended( frameCount, model.frameCount() - 1 );
+
 	if ( model.channelCount() == 0 )
 		return;
 
@@ -112,27 +116,25 @@ void QDataAnalysisView::setTime( double time, bool refreshAll )
 	// draw stuff if visible
 	if ( isVisible() )
 	{
-		int itemCount = refreshAll ? int( model.channelCount() ) : std::min<int>( smallRefreshItemCount, int( model.channelCount() ) );
-		itemList->setUpdatesEnabled( false );
-		for ( size_t i = 0; i < itemCount; ++i )
-		{
-			auto y = model.value( currentUpdateIdx, time );
-			itemList->topLevelItem( currentUpdateIdx )->setText( 1, QString::asprintf( "%.*f", decimalPoints( y ), y ) );
-			++currentUpdateIdx %= model.channelCount();
-		}
-		itemList->setUpdatesEnabled( true );
+		// only rows inside the viewport are refreshed, values are formatted on demand
+		auto top = itemList->indexAt( QPoint( 0, 0 ) );
+		auto bottom = itemList->indexAt( QPoint( 0, itemList->viewport()->height() - 1 ) );
+		itemModel->setTime( time, top.isValid() ? top.row() : 0, bottom.isValid() ? bottom.row() : itemModel->rowCount() - 1 );
 
 		// update graph
 		updateIndicator();
 		if ( refreshAll )
-			customPlot->replot( QCustomPlot::rpQueued );
+			customPlotLine->layer()->replot();
 	}
 }
 
-void QDataAnalysisView::itemChanged( QTreeWidgetItem* item, int column )
+void QDataAnalysisView::itemDataChanged( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector< int >& roles )
 {
-	if ( column == 0 )
-		updateSeries( itemList->indexOfTopLevelItem( item ) );
+	if ( topLeft.column() == 0 && roles.contains( Qt::CheckStateRole ) )
+	{
+		for ( int row = topLeft.row(); row <= bottomRight.row(); ++row )
+			updateSeries( itemModel->channel( row ) );
+	}
 }
 
 void QDataAnalysisView::clearSeries()
@@ -191,12 +193,8 @@ void QDataAnalysisView::setSelectionState( int state )
 {
 	if ( state != Qt::PartiallyChecked )
 	{
-		for ( int i = 0; i < itemList->topLevelItemCount(); ++i )
-		{
-			auto* item = itemList->topLevelItem( i );
-			if ( !item->isHidden() && item->checkState( 0 ) != state )
-				item->setCheckState( 0, Qt::CheckState( state ) );
-		}
+		for ( int row = 0; row < itemModel->rowCount(); ++row )
+			itemModel->setChecked( itemModel->channel( row ), state == Qt::Checked );
 	}
 }
 
@@ -204,20 +202,22 @@ void QDataAnalysisView::reloadData()
 {
 	GUI_PROFILE_FUNCTION;
 
-	itemList->clear();
 	clearSeries();
+	keyCache->invalidate();
+	itemModel->reset();
 
 	for ( int i = 0; i < model.channelCount(); ++i )
 	{
-		auto* wdg = new QTreeWidgetItem( itemList, QStringList( model.label( i ) ) );
-		wdg->setTextAlignment( 1, Qt::AlignRight );
-		wdg->setFlags( wdg->flags() | Qt::ItemIsUserCheckable );
-		wdg->setCheckState( 0, persistentSerieNames.find( model.label( i ) ) != persistentSerieNames.end() ? Qt::Checked : Qt::Unchecked );
+		if ( persistentSerieNames.find( itemModel->label( i ) ) != persistentSerieNames.end() )
+		{
+			itemModel->setChecked( i, true );
+			updateSeries( i );
+		}
 	}
 	itemList->resizeColumnToContents( 0 );
 
-	currentUpdateIdx = 0;
 	currentTime = 0.0;
+	frameCount = model.frameCount();
 	updateIndicator();
 	updateFilter();
 }
@@ -236,33 +236,17 @@ void QDataAnalysisView::updateIndicator()
 
 void QDataAnalysisView::updateFilter()
 {
-	//selectAllButton->setDisabled( filter->text().isEmpty() );
-	auto regexp = QRegExp( filter->text(), Qt::CaseSensitive, QRegExp::Wildcard );
-	for ( int i = 0; i < itemList->topLevelItemCount(); ++i )
-	{
-		auto* item = itemList->topLevelItem( i );
-		const auto& s = item->text( 0 );
-		bool match = s.contains( filter->text() ) || regexp.exactMatch( s );
-		item->setHidden( !match );
-	}
+	GUI_PROFILE_FUNCTION;
 
+	//selectAllButton->setDisabled( filter->text().isEmpty() );
+	itemModel->setFilter( filter->text() );
 	updateSelectBox();
 }
 
 void QDataAnalysisView::updateSelectBox()
 {
-	size_t checked_count = 0;
-	size_t shown_count = 0;
-
-	for ( int i = 0; i < itemList->topLevelItemCount(); ++i )
-	{
-		auto* item = itemList->topLevelItem( i );
-		if ( !item->isHidden() )
-		{
-			shown_count++;
-			checked_count += item->checkState( 0 ) == Qt::Checked;
-		}
-	}
+	size_t checked_count = itemModel->checkedRowCount();
+	size_t shown_count = itemModel->rowCount();
 
 	selectBox->blockSignals( true );
 	selectBox->setCheckState( checked_count > 0 ? ( shown_count == checked_count ? Qt::Checked : Qt::Checked ) : Qt::Unchecked );
@@ -271,17 +255,35 @@ void QDataAnalysisView::updateSelectBox()
 
 void QDataAnalysisView::fitVerticalAxis()
 {
+	GUI_PROFILE_FUNCTION;
+
 	//xo::bounds<double> yrange( xo::num<double>::max, xo::num<double>::lowest );
 	xo::bounds<double> yrange( 0, 0 );
 	auto xrange = customPlot->xAxis->range();
-	int end_frame = model.timeIndex( xrange.upper );
-	for ( int frame = model.timeIndex( xrange.lower ); frame <= end_frame; ++frame )
-		for ( auto& s : series )
-			yrange.extend( model.value( s.channel, frame ) );
+	int first_frame = model.timeIndex( xrange.lower );
+	int last_frame = model.timeIndex( xrange.upper );
+	for ( auto& s : series )
+	{
+		// range queries are answered by the graph pyramid, independent of zoom level
+		bool found = false;
+		auto r = s.graph->valueRange( first_frame, last_frame, found );
+		if ( found )
+		{
+			yrange.extend( r.lower );
+			yrange.extend( r.upper );
+		}
+	}
 
 	customPlot->yAxis->setRange( yrange.lower, yrange.upper );
 }
 
+void QDataAnalysisView::updateAverageFrameDuration()
+{
+	if ( model.frameCount() > 0 )
+		averageFrameDuration = ( model.timeFinish() - model.timeStart() ) / model.frameCount();
+	else averageFrameDuration = 0.0f;
+}
+
 void QDataAnalysisView::updateSeriesStyle()
 {
 	auto zoom = averageFrameDuration * customPlot->xAxis->axisRect()->width() / customPlot->xAxis->range().size();
@@ -292,30 +294,26 @@ void QDataAnalysisView::updateSeriesStyle()
 		seriesStyle = newstyle;
 		QCPScatterStyle ss = QCPScatterStyle( seriesStyle == discStyle ? QCPScatterStyle::ssDisc : QCPScatterStyle::ssNone, 4 );
 		for ( auto& s : series )
-		{
 			s.graph->setScatterStyle( ss );
-			s.graph->setLineStyle( QCPGraph::lsLine );
-		}
 	}
 }
 
 void QDataAnalysisView::updateSeries( int idx )
 {
-	auto item = itemList->topLevelItem( idx );
 	auto series_it = xo::find_if( series, [&]( auto& p ) { return idx == p.channel; } );
-	if ( item->checkState( 0 ) == Qt::Checked && series_it == series.end() )
+	if ( itemModel->isChecked( idx ) && series_it == series.end() )
 	{
 		if ( series.size() < maxSeriesCount )
 		{
 			addSeries( idx );
-			persistentSerieNames.insert( model.label( idx ) );
+			persistentSerieNames.insert( itemModel->label( idx ) );
 		}
-		else item->setCheckState( 0, Qt::Unchecked );
+		else itemModel->setChecked( idx, false );
 	}
-	else if ( series_it != series.end() && item->checkState( 0 ) == Qt::Unchecked )
+	else if ( series_it != series.end() && !itemModel->isChecked( idx ) )
 	{
 		removeSeries( idx );
-		persistentSerieNames.remove( model.label( idx ) );
+		persistentSerieNames.remove( itemModel->label( idx ) );
 	}
 	updateSelectBox();
 }
@@ -324,48 +322,59 @@ void QDataAnalysisView::addSeries( int idx )
 {
 	GUI_PROFILE_FUNCTION;
 
-	QCPGraph* graph = customPlot->addGraph();
-	QString name = model.label( idx );
-	graph->setName( name );
-
-	xo_assert( !freeColors.empty() );
+	auto* graph = new QDataAnalysisGraph( model, idx, customPlot->xAxis, customPlot->yAxis, keyCache );
+	customPlot->addPlottable( graph );
+	graph->setName( itemModel->label( idx ) );
+	connect( graph, &QDataAnalysisGraph::prepared, this, &QDataAnalysisView::schedulePlotUpdate );
+	graph->prepareAsync();
 
-	auto color = to_qt( xo::make_unique_color( freeColors.front() ) );
+	auto color_idx = nextSeriesColor();
+	auto color = to_qt( xo::make_unique_color( color_idx ) );
 	graph->setScatterStyle( QCPScatterStyle( seriesStyle == discStyle ? QCPScatterStyle::ssDisc : QCPScatterStyle::ssNone, 4 ) );
 	graph->setPen( QPen( color, lineWidth ) );
 
-	for ( int frame = 0; frame < model.frameCount(); ++frame )
-		graph->addData( model.timeValue( frame ), model.value( idx, frame ) );
-	if ( model.frameCount() > 0 )
-		averageFrameDuration = ( model.timeFinish() - model.timeStart() ) / model.frameCount();
-	else averageFrameDuration = 0.0f;
+	updateAverageFrameDuration();
 
-	series.emplace_back( Series{ idx, freeColors.front(), graph } );
-	freeColors.erase( freeColors.begin() );
+	series.emplace_back( Series{ idx, color_idx, graph } );
 
 	updateSeriesStyle();
-
-	auto range = customPlot->xAxis->range();
-	customPlot->rescaleAxes();
-	customPlot->xAxis->setRange( range );
-	updateIndicator();
-	customPlot->replot();
+	updateLegend();
+	schedulePlotUpdate();
 }
 
 void QDataAnalysisView::removeSeries( int idx )
 {
 	GUI_PROFILE_FUNCTION;
 
-	auto range = customPlot->xAxis->range();
 	auto it = xo::find_if( series, [&]( auto& p ) { return idx == p.channel; } );
 
-	freeColors.insert( it->color );
 	if ( it->graph )
-		customPlot->removeGraph( it->graph );
+		customPlot->removePlottable( it->graph );
 	series.erase( it );
+	updateLegend();
+	schedulePlotUpdate();
+}
+
+void QDataAnalysisView::schedulePlotUpdate()
+{
+	// checking many items at once results in a single rescale and replot
+	if ( !plotUpdatePending )
+	{
+		plotUpdatePending = true;
+		QTimer::singleShot( 0, this, &QDataAnalysisView::updatePlot );
+	}
+}
+
+void QDataAnalysisView::updatePlot()
+{
+	GUI_PROFILE_FUNCTION;
 
+	plotUpdatePending = false;
+	auto range = customPlot->xAxis->range();
 	customPlot->rescaleAxes();
 	customPlot->xAxis->setRange( range );
+	if ( autoFitVerticalAxis )
+		fitVerticalAxis();
 	updateIndicator();
 	customPlot->replot();
 }
@@ -376,14 +385,15 @@ void QDataAnalysisView::holdSeries()
 
 	// remove existing 
 	for ( auto* g : heldSeries )
-		customPlot->removeGraph( g );
+		customPlot->removePlottable( g );
 	heldSeries.clear();
 
-	// copy from series
+	// held graphs share the single precision snapshot of the series, holding again without new data is O(1)
 	for ( auto& s : series )
 	{
-		auto* graph = customPlot->addGraph();
-		graph->setData( s.graph->data(), true );
+		auto* graph = new QCPCompactGraph( customPlot->xAxis, customPlot->yAxis );
+		customPlot->addPlottable( graph );
+		graph->setData( s.graph->snapshot() );
 		graph->setName( s.graph->name() );
 		graph->setPen( QPen( s.graph->pen().color().lighter(), lineWidth ) );
 		heldSeries.push_back( graph );
@@ -392,6 +402,66 @@ void QDataAnalysisView::holdSeries()
 	customPlot->replot();
 }
 
+void QDataAnalysisView::framesAppended( int first, int last )
+{
+	GUI_PROFILE_FUNCTION;
+
+	if ( model.frameCount() < frameCount )
+		return framesRemoved();
+	if ( last < first || last >= model.frameCount() )
+		return;
+
+	// graphs read from the model directly and only extend their pyramids for the new frames,
+	// so only the axes need to catch up with the head
+	auto range = customPlot->xAxis->range();
+	const bool showsHead = first == 0 || range.upper >= model.timeValue( first - 1 );
+	frameCount = last + 1;
+	updateAverageFrameDuration();
+
+	if ( followHead )
+		range += model.timeFinish() - range.upper;
+	else if ( showsHead )
+		range.upper = model.timeFinish();
+	customPlot->xAxis->setRange( range );
+
+	if ( !autoFitVerticalAxis )
+		for ( auto& s : series )
+			s.graph->rescaleValueAxis( true );
+	updateIndicator();
+	customPlot->replot( QCustomPlot::rpQueued );
+}
+
+void QDataAnalysisView::framesRemoved()
+{
+	// the model was cleared or restarted, graphs and their pyramids refer to frames that are gone
+	reloadData();
+	updateAverageFrameDuration();
+	if ( model.frameCount() > 0 )
+		customPlot->xAxis->setRange( model.timeStart(), model.timeFinish() );
+	customPlot->replot( QCustomPlot::rpQueued );
+}
+
+void QDataAnalysisView::updateLegend()
+{
+	// with many series, only the first ones are listed in the legend
+	for ( size_t i = 0; i < series.size(); ++i )
+	{
+		if ( i < maxLegendItemCount )
+			series[ i ].graph->addToLegend();
+		else series[ i ].graph->removeFromLegend();
+	}
+}
+
+int QDataAnalysisView::nextSeriesColor() const
+{
+	// lowest color index that is not in use
+	std::vector< bool > used( series.size() + 1, false );
+	for ( auto& s : series )
+		if ( s.color < int( used.size() ) )
+			used[ s.color ] = true;
+	return int( std::find( used.begin(), used.end(), false ) - used.begin() );
+}
+
 void QDataAnalysisView::legendClick()
 {
 	auto cur_align = customPlot->axisRect()->insetLayout()->insetAlignment( 0 );
@@ -6,18 +6,22 @@
 
 #include <QWidget>
 #include <QSplitter>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QLineEdit>
 #include <QGroup.h>
 #include <QCheckBox>
 #include <QPushButton>
+#include <memory>
 
 #include "QDataAnalysisModel.h"
+#include "QDataAnalysisItemModel.h"
 
 class QCPRange;
 class QCustomPlot;
 class QCPItemLine;
-class QCPGraph;
+class QCPCompactGraph;
+class QDataAnalysisGraph;
+class QDataAnalysisKeyCache;
 
 class QDataAnalysisView : public QWidget
 {
@@ -32,12 +36,15 @@ public:
 	void setRange( double lower, double upper );
 	void setLineWidth( float f ) { lineWidth = f; }
 	void setAutoFitVerticalAxis( bool b ) { autoFitVerticalAxis = b; }
+	void setFollowHead( bool b ) { followHead = b; }
+	void setMaxSeriesCount( size_t n ) { maxSeriesCount = n; }
+	void setMaxLegendItemCount( size_t n ) { maxLegendItemCount = n; updateLegend(); }
 	void setFilterText( const QString& str ) { filter->setText( str ); }
 	QLineEdit* filterWidget() { return filter; }
 	QVGroup* itemGroupWidget() { return itemGroup; }
 
 public slots:
-	void itemChanged( QTreeWidgetItem* item, int column );
+	void itemDataChanged( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector< int >& roles );
 	void clearSeries();
 	void updateSeries( int index );
 	void mouseEvent( QMouseEvent* m );
@@ -50,6 +57,9 @@ public slots:
 	void holdSeries();
 	void focusFilterEdit() { show(); filter->setFocus(); }
 	void legendClick();
+	void framesAppended( int first, int last );
+	void schedulePlotUpdate();
+	void updatePlot();
 
 signals:
 	void timeChanged( double );
@@ -61,39 +71,45 @@ private:
 	void updateFilter();
 	void updateSelectBox();
 	void fitVerticalAxis();
-	int decimalPoints( double v );
+	void updateAverageFrameDuration();
+	void framesRemoved();
+	void updateLegend();
+	int nextSeriesColor() const;
 
 	enum SeriesStyle { noStyle, lineStyle, discStyle };
 	SeriesStyle seriesStyle = noStyle;
-	size_t maxSeriesCount = 20;
-	int smallRefreshItemCount = 100;
+	size_t maxSeriesCount = 500;
+	size_t maxLegendItemCount = 16;
 	float averageFrameDuration = 0.0f;
 	float lineWidth = 1.0f;
 	bool autoFitVerticalAxis = false;
+	bool followHead = false;
+	bool plotUpdatePending = false;
 	float minDataPointsVisible = 8;
 
-	int currentUpdateIdx;
+	int frameCount = 0;
 	double currentTime;
 	QCheckBox* selectBox;
 	QLineEdit* filter;
 	QGroup* filterGroup;
 	QSplitter* splitter;
 	QVGroup* itemGroup;
-	QTreeWidget* itemList;
+	QTreeView* itemList;
+	QDataAnalysisItemModel* itemModel;
 	QPushButton* keepButton;
 	QDataAnalysisModel& model;
 
 	QCustomPlot* customPlot;
 	QCPItemLine* customPlotLine;
-	xo::sorted_vector< int > freeColors;
+	std::shared_ptr< QDataAnalysisKeyCache > keyCache;
 
 	struct Series {
 		int channel;
 		int color;
-		QCPGraph* graph;
+		QDataAnalysisGraph* graph;
 	};
 	std::vector< Series > series;
-	std::vector< QCPGraph* > heldSeries;
+	std::vector< QCPCompactGraph* > heldSeries;
 	xo::sorted_vector< QString > persistentSerieNames;
 
 	void updateSeriesStyle();
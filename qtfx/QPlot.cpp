@@ -1,40 +1,130 @@
 #include "QPlot.h"
 
-QPlot::QPlot( QWidget* parent )
+#include "qcustomplot/qcustomplot.h"
+#include "QStreamGraph.h"
+#include "QTimer"
+#include "QVBoxLayout"
+#include "qt_convert.h"
+
+#include "xo/numerical/bounds.h"
+#include "xo/utility/color.h"
+
+QPlot::QPlot( QWidget* parent ) :
+	QWidget( parent ),
+	historySize( 10000 ),
+	keyWindow( 0.0 ),
+	autoRangeKeys( true ),
+	updatePending( false )
 {
-#if defined QTFX_USE_QCUSTOMPLOT
-	customPlot = new QCustomPlot();
+	customPlot = new QCustomPlot( this );
 	customPlot->setInteraction( QCP::iRangeZoom, true );
 	customPlot->setInteraction( QCP::iRangeDrag, true );
 	customPlot->axisRect()->setRangeDrag( Qt::Horizontal );
 	customPlot->axisRect()->setRangeZoom( Qt::Horizontal );
-#else
-	chart = new QtCharts::QChart();
-	chart->setBackgroundRoundness( 0 );
-	chart->setMargins( QMargins( 4, 4, 4, 4 ) );
-	chart->layout()->setContentsMargins( 0, 0, 0, 0 );
-	chart->legend()->setAlignment( Qt::AlignRight );
-	chart->createDefaultAxes();
-	chartView = new QtCharts::QChartView( chart, this );
-	chartView->setContentsMargins( 0, 0, 0, 0 );
-	chartView->setRenderHint( QPainter::Antialiasing );
-	chartView->setRubberBand( QtCharts::QChartView::RectangleRubberBand );
-	chartView->setBackgroundBrush( QBrush( Qt::red ) );
-	chartView->resize( 300, 100 );
-#endif
+	customPlot->legend->setFont( font() );
+	customPlot->legend->setRowSpacing( -6 );
+
+	// dragging or zooming keeps the key range where the user put it, double-click resumes
+	connect( customPlot, &QCustomPlot::mouseMove, this, [this]( QMouseEvent* e ) { if ( e->buttons() & Qt::LeftButton ) autoRangeKeys = false; } );
+	connect( customPlot, &QCustomPlot::mouseWheel, this, [this]( QWheelEvent* ) { autoRangeKeys = false; } );
+	connect( customPlot, &QCustomPlot::mouseDoubleClick, this, [this]( QMouseEvent* ) { resetKeyRange(); } );
+
+	QVBoxLayout* layout = new QVBoxLayout( this );
+	setLayout( layout );
+	layout->setContentsMargins( 0, 0, 0, 0 );
+	layout->addWidget( customPlot );
 }
 
 QPlot::~QPlot()
+{}
+
+size_t QPlot::addSeries( const QString& label )
 {
+	auto* graph = new QStreamGraph( customPlot->xAxis, customPlot->yAxis, historySize );
+	customPlot->addPlottable( graph );
+	graph->setName( label );
+	graph->setPen( QPen( to_qt( xo::make_unique_color( series.size() ) ), 1 ) );
+	series.push_back( graph );
+	customPlot->legend->setVisible( series.size() > 1 );
+	scheduleUpdate();
+	return series.size() - 1;
+}
 
+void QPlot::addData( size_t idx, double key, double value )
+{
+	series[ idx ]->addData( key, value );
+	if ( keyWindow > 0 )
+		series[ idx ]->removeDataBefore( key - keyWindow );
+	scheduleUpdate();
 }
 
-size_t QPlot::addSeries( const QString& label )
+void QPlot::clearData()
+{
+	for ( auto* s : series )
+		s->clearData();
+	autoRangeKeys = true;
+	scheduleUpdate();
+}
+
+void QPlot::setHistorySize( int samples )
 {
-	QtCharts::QLineSeries* ls = new QtCharts::QLineSeries;
-	ls->setName( label );
-	chart->addSeries( ls );
-	chart->createDefaultAxes();
-	chart->zoomReset();
-	return chart->series().size() - 1;
+	historySize = samples;
+	for ( auto* s : series )
+		s->setCapacity( historySize );
+	scheduleUpdate();
+}
+
+void QPlot::resetKeyRange()
+{
+	autoRangeKeys = true;
+	scheduleUpdate();
+}
+
+void QPlot::scheduleUpdate()
+{
+	// samples that arrive before the next frame are drawn with a single replot
+	if ( !updatePending )
+	{
+		updatePending = true;
+		QTimer::singleShot( updateInterval, this, [this]() { updatePlot(); } );
+	}
+}
+
+void QPlot::updatePlot()
+{
+	updatePending = false;
+
+	// the ranges of stream graphs are known without going through the samples
+	xo::bounds< double > keys( 0, 0 ), values( 0, 0 );
+	bool found = false;
+	for ( auto* s : series )
+	{
+		bool foundKeys = false, foundValues = false;
+		auto kr = s->data().keyRange( foundKeys );
+		auto vr = s->data().valueRange( foundValues );
+		if ( !foundKeys )
+			continue;
+		if ( !found )
+			keys = xo::bounds< double >( kr.lower, kr.upper );
+		keys.extend( kr.lower );
+		keys.extend( kr.upper );
+		if ( foundValues )
+		{
+			values.extend( vr.lower );
+			values.extend( vr.upper );
+		}
+		found = true;
+	}
+
+	if ( found )
+	{
+		if ( autoRangeKeys )
+		{
+			if ( keyWindow > 0 )
+				customPlot->xAxis->setRange( keys.upper - keyWindow, keys.upper );
+			else customPlot->xAxis->setRange( keys.lower, keys.upper );
+		}
+		customPlot->yAxis->setRange( values.lower, values.upper );
+	}
+	customPlot->replot();
 }
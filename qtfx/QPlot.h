@@ -1,16 +1,13 @@
 #pragma once
 
-#if defined QTFX_USE_QCUSTOMPLOT
-#include "qcustomplot.h"
-#else
-#include "QtCharts/QChart"
-#include "QtCharts/QLineSeries"
-#include "QtCharts/QChartView"
-#include "QtWidgets/QGraphicsLayout"
-#endif
 #include <vector>
-#include "flut/system/assert.hpp"
+#include <QWidget>
 
+class QCustomPlot;
+class QStreamGraph;
+
+// lightweight plot of series that grow over time; each series keeps a bounded history,
+// appended samples are collected and drawn at most once per updateInterval
 class QPlot : public QWidget
 {
 public:
@@ -18,13 +15,35 @@ public:
 	virtual ~QPlot();
 
 	size_t addSeries( const QString& label );
-		
+	size_t seriesCount() const { return series.size(); }
+
+	// keys must not decrease within a series
+	void addData( size_t idx, double key, double value );
+	void clearData();
+
+	// maximum number of samples per series, changing it clears the data
+	void setHistorySize( int samples );
+	int getHistorySize() const { return historySize; }
+
+	// if width > 0, only samples within width of the last key are kept and shown
+	void setKeyWindow( double width ) { keyWindow = width; scheduleUpdate(); }
+	double getKeyWindow() const { return keyWindow; }
+
+	// follows the data again after the user dragged or zoomed the keys, same as double-click
+	void resetKeyRange();
+
+	QCustomPlot* getCustomPlot() { return customPlot; }
+
 private:
+	static constexpr int updateInterval = 16; // ms, about 60 Hz
+
+	void scheduleUpdate();
+	void updatePlot();
 
-#if defined QTFX_USE_QCUSTOMPLOT
 	QCustomPlot* customPlot;
-#else
-	QtCharts::QChart* chart;
-	QtCharts::QChartView* chartView;
-#endif
+	std::vector< QStreamGraph* > series;
+	int historySize;
+	double keyWindow;
+	bool autoRangeKeys;
+	bool updatePending;
 };
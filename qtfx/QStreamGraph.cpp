@@ -0,0 +1,282 @@
+#include "QStreamGraph.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	void extendRange( QCPRange& range, bool& foundRange, double v )
+	{
+		if ( !foundRange )
+		{
+			range = QCPRange( v, v );
+			foundRange = true;
+		}
+		else if ( v < range.lower )
+			range.lower = v;
+		else if ( v > range.upper )
+			range.upper = v;
+	}
+
+	bool inDomain( double v, QCPAbstractPlottable::SignDomain domain )
+	{
+		if ( qIsNaN( v ) )
+			return false;
+		if ( domain == QCPAbstractPlottable::sdNegative )
+			return v < 0;
+		if ( domain == QCPAbstractPlottable::sdPositive )
+			return v > 0;
+		return true;
+	}
+
+	void drawPolylineSegments( QCPPainter* painter, const QVector< QPointF >& points )
+	{
+		// NaNs create a gap in the line
+		int segmentStart = 0;
+		for ( int i = 0; i < points.size(); ++i )
+		{
+			if ( qIsNaN( points[ i ].x() ) || qIsNaN( points[ i ].y() ) || qIsInf( points[ i ].y() ) )
+			{
+				if ( i - segmentStart > 1 )
+					painter->drawPolyline( points.constData() + segmentStart, i - segmentStart );
+				segmentStart = i + 1;
+			}
+		}
+		if ( points.size() - segmentStart > 1 )
+			painter->drawPolyline( points.constData() + segmentStart, points.size() - segmentStart );
+	}
+}
+
+void QStreamBuffer::setCapacity( int capacity )
+{
+	capacity_ = std::max( capacity, 0 );
+	keys_.assign( capacity_, 0.0 );
+	values_.assign( capacity_, 0.0 );
+	clear();
+}
+
+void QStreamBuffer::clear()
+{
+	head_ = size_ = 0;
+	pushed_ = 0;
+	minQueue_.reset( capacity_ );
+	maxQueue_.reset( capacity_ );
+}
+
+void QStreamBuffer::push( double key, double value )
+{
+	if ( capacity_ <= 0 )
+		return;
+	if ( size_ == capacity_ )
+		popFront();
+
+	// the sample with sequence number s is stored at s % capacity
+	const auto s = pushed_++;
+	const auto p = size_t( s % std::uint64_t( capacity_ ) );
+	keys_[ p ] = key;
+	values_[ p ] = value;
+	++size_;
+
+	if ( !qIsNaN( value ) )
+	{
+		// samples that are dominated by the new one can never become the extreme again
+		while ( !minQueue_.empty() && sequenceValue( minQueue_.back() ) >= value )
+			minQueue_.popBack();
+		minQueue_.pushBack( s );
+		while ( !maxQueue_.empty() && sequenceValue( maxQueue_.back() ) <= value )
+			maxQueue_.popBack();
+		maxQueue_.pushBack( s );
+	}
+}
+
+void QStreamBuffer::expireBefore( double key )
+{
+	while ( size_ > 0 && keys_[ head_ ] < key )
+		popFront();
+}
+
+void QStreamBuffer::popFront()
+{
+	const auto s = pushed_ - size_;
+	if ( !minQueue_.empty() && minQueue_.front() == s )
+		minQueue_.popFront();
+	if ( !maxQueue_.empty() && maxQueue_.front() == s )
+		maxQueue_.popFront();
+	head_ = physical( 1 );
+	--size_;
+}
+
+int QStreamBuffer::lowerIndex( double k ) const
+{
+	int lo = 0, hi = size_;
+	while ( lo < hi )
+	{
+		int mid = lo + ( hi - lo ) / 2;
+		if ( key( mid ) < k )
+			lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+int QStreamBuffer::upperIndex( double k ) const
+{
+	int lo = 0, hi = size_;
+	while ( lo < hi )
+	{
+		int mid = lo + ( hi - lo ) / 2;
+		if ( key( mid ) <= k )
+			lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+QCPRange QStreamBuffer::keyRange( bool& foundRange ) const
+{
+	foundRange = size_ > 0;
+	return foundRange ? QCPRange( key( 0 ), key( size_ - 1 ) ) : QCPRange();
+}
+
+QCPRange QStreamBuffer::valueRange( bool& foundRange ) const
+{
+	foundRange = !minQueue_.empty();
+	return foundRange ? QCPRange( sequenceValue( minQueue_.front() ), sequenceValue( maxQueue_.front() ) ) : QCPRange();
+}
+
+QStreamGraph::QStreamGraph( QCPAxis* keyAxis, QCPAxis* valueAxis, int capacity ) :
+	QCPAbstractPlottable( keyAxis, valueAxis ),
+	data_( capacity )
+{
+	setPen( QPen( Qt::blue, 0 ) );
+	setBrush( Qt::NoBrush );
+	setSelectedPen( QPen( QColor( 80, 80, 255 ), 2.5 ) );
+	setSelectedBrush( Qt::NoBrush );
+}
+
+double QStreamGraph::selectTest( const QPointF& pos, bool onlySelectable, QVariant* details ) const
+{
+	Q_UNUSED( details )
+	if ( ( onlySelectable && !mSelectable ) || !mKeyAxis || !mValueAxis || data_.empty() )
+		return -1;
+	if ( !mKeyAxis.data()->axisRect()->rect().contains( pos.toPoint() ) )
+		return -1;
+
+	double key, value;
+	pixelsToCoords( pos, key, value );
+	const int n = data_.size();
+	const auto p1 = toPixels( data_.key( 0 ), data_.value( 0 ) );
+	if ( n == 1 )
+		return QVector2D( p1 - pos ).length();
+	const int i = std::clamp( data_.lowerIndex( key ), 1, n - 1 );
+	return std::sqrt( distSqrToLine( toPixels( data_.key( i - 1 ), data_.value( i - 1 ) ), toPixels( data_.key( i ), data_.value( i ) ), pos ) );
+}
+
+void QStreamGraph::draw( QCPPainter* painter )
+{
+	QCPAxis* keyAxis = mKeyAxis.data();
+	QCPAxis* valueAxis = mValueAxis.data();
+	if ( !keyAxis || !valueAxis || keyAxis->range().size() <= 0 || data_.empty() )
+		return;
+
+	// visible samples, including one on either side so the line reaches the border
+	const int first = std::max( data_.lowerIndex( keyAxis->range().lower ) - 1, 0 );
+	const int last = std::min( data_.upperIndex( keyAxis->range().upper ), data_.size() - 1 );
+	if ( first > last )
+		return;
+
+	lineData_.clear();
+	const int pixelCount = keyAxis->orientation() == Qt::Horizontal ? keyAxis->axisRect()->width() : keyAxis->axisRect()->height();
+	const bool decimate = last - first + 1 > 2 * pixelCount;
+	if ( decimate )
+	{
+		// more than two samples per pixel, only draw the extremes of each pixel column
+		lineData_.reserve( 2 * pixelCount + 4 );
+		int f = first;
+		while ( f <= last )
+		{
+			const double column = std::floor( keyAxis->coordToPixel( data_.key( f ) ) );
+			int imin = f, imax = f;
+			for ( ++f; f <= last && std::floor( keyAxis->coordToPixel( data_.key( f ) ) ) == column; ++f )
+			{
+				const double v = data_.value( f );
+				if ( v < data_.value( imin ) || qIsNaN( data_.value( imin ) ) )
+					imin = f;
+				if ( v > data_.value( imax ) || qIsNaN( data_.value( imax ) ) )
+					imax = f;
+			}
+			const int i1 = std::min( imin, imax ), i2 = std::max( imin, imax );
+			lineData_.append( toPixels( data_.key( i1 ), data_.value( i1 ) ) );
+			if ( i2 != i1 )
+				lineData_.append( toPixels( data_.key( i2 ), data_.value( i2 ) ) );
+		}
+	}
+	else
+	{
+		lineData_.reserve( last - first + 1 );
+		for ( int f = first; f <= last; ++f )
+			lineData_.append( toPixels( data_.key( f ), data_.value( f ) ) );
+	}
+
+	if ( mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0 )
+	{
+		applyDefaultAntialiasingHint( painter );
+		painter->setPen( mainPen() );
+		painter->setBrush( Qt::NoBrush );
+		drawPolylineSegments( painter, lineData_ );
+	}
+
+	if ( !decimate && !scatterStyle_.isNone() )
+	{
+		applyScattersAntialiasingHint( painter );
+		scatterStyle_.applyTo( painter, mPen );
+		scatterStyle_.drawShapes( painter, lineData_ );
+	}
+}
+
+void QStreamGraph::drawLegendIcon( QCPPainter* painter, const QRectF& rect ) const
+{
+	applyDefaultAntialiasingHint( painter );
+	painter->setPen( mPen );
+	painter->drawLine( QLineF( rect.left(), rect.top() + rect.height() / 2.0, rect.right() + 5, rect.top() + rect.height() / 2.0 ) );
+	if ( !scatterStyle_.isNone() && scatterStyle_.shape() != QCPScatterStyle::ssPixmap )
+	{
+		applyScattersAntialiasingHint( painter );
+		scatterStyle_.applyTo( painter, mPen );
+		scatterStyle_.drawShape( painter, QRectF( rect ).center() );
+	}
+}
+
+QCPRange QStreamGraph::getKeyRange( bool& foundRange, SignDomain inSignDomain ) const
+{
+	if ( inSignDomain == sdBoth )
+		return data_.keyRange( foundRange );
+
+	QCPRange range;
+	foundRange = false;
+	for ( int i = 0; i < data_.size(); ++i )
+		if ( inDomain( data_.key( i ), inSignDomain ) )
+			extendRange( range, foundRange, data_.key( i ) );
+	return range;
+}
+
+QCPRange QStreamGraph::getValueRange( bool& foundRange, SignDomain inSignDomain ) const
+{
+	if ( inSignDomain == sdBoth )
+		return data_.valueRange( foundRange );
+
+	// only needed for logarithmic axes, which are rare for live data
+	QCPRange range;
+	foundRange = false;
+	for ( int i = 0; i < data_.size(); ++i )
+		if ( inDomain( data_.value( i ), inSignDomain ) )
+			extendRange( range, foundRange, data_.value( i ) );
+	return range;
+}
+
+QPointF QStreamGraph::toPixels( double key, double value ) const
+{
+	if ( mKeyAxis.data()->orientation() == Qt::Vertical )
+		return QPointF( mValueAxis.data()->coordToPixel( value ), mKeyAxis.data()->coordToPixel( key ) );
+	else return QPointF( mKeyAxis.data()->coordToPixel( key ), mValueAxis.data()->coordToPixel( value ) );
+}
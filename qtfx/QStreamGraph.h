@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "qcustomplot/qcustomplot.h"
+
+// fixed capacity ring buffer of samples with non-decreasing keys; pushing into a full buffer
+// replaces the oldest sample, and the value extremes are kept up to date while samples enter
+// and leave, so pushing and expiring take amortized constant time and memory never grows
+class QStreamBuffer
+{
+public:
+	QStreamBuffer( int capacity = 0 ) { setCapacity( capacity ); }
+
+	// changes the capacity, which clears the buffer
+	void setCapacity( int capacity );
+	void clear();
+
+	// key must not be smaller than the key of the last pushed sample
+	void push( double key, double value );
+	// removes samples from the front until key( 0 ) >= key
+	void expireBefore( double key );
+
+	int capacity() const { return capacity_; }
+	int size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	double key( int i ) const { return keys_[ physical( i ) ]; }
+	double value( int i ) const { return values_[ physical( i ) ]; }
+
+	// index of the first sample with key >= k / key > k
+	int lowerIndex( double k ) const;
+	int upperIndex( double k ) const;
+
+	QCPRange keyRange( bool& foundRange ) const;
+	QCPRange valueRange( bool& foundRange ) const; // NaN values are ignored
+
+private:
+	// ring of sample sequence numbers, the size is bounded by the buffer capacity
+	class SequenceQueue
+	{
+	public:
+		void reset( int capacity ) { items_.assign( capacity, 0 ); head_ = size_ = 0; }
+		bool empty() const { return size_ == 0; }
+		std::uint64_t front() const { return items_[ head_ ]; }
+		std::uint64_t back() const { return items_[ index( size_ - 1 ) ]; }
+		void pushBack( std::uint64_t s ) { items_[ index( size_++ ) ] = s; }
+		void popBack() { --size_; }
+		void popFront() { head_ = index( 1 ); --size_; }
+
+	private:
+		int index( int i ) const { int p = head_ + i; return p < int( items_.size() ) ? p : p - int( items_.size() ); }
+		std::vector< std::uint64_t > items_;
+		int head_ = 0, size_ = 0;
+	};
+
+	int physical( int i ) const { int p = head_ + i; return p < capacity_ ? p : p - capacity_; }
+	double sequenceValue( std::uint64_t s ) const { return values_[ size_t( s % std::uint64_t( capacity_ ) ) ]; }
+	void popFront();
+
+	int capacity_ = 0;
+	int head_ = 0;
+	int size_ = 0;
+	std::uint64_t pushed_ = 0; // sequence number of the next sample, the sample at head_ has pushed_ - size_
+	std::vector< double > keys_;
+	std::vector< double > values_;
+	SequenceQueue minQueue_; // increasing values, front is the minimum
+	SequenceQueue maxQueue_; // decreasing values, front is the maximum
+};
+
+// plottable for live data that scrolls through a fixed size window; samples are drawn as
+// min / max per pixel column when there are more samples than pixels
+class QStreamGraph : public QCPAbstractPlottable
+{
+	Q_OBJECT
+
+public:
+	QStreamGraph( QCPAxis* keyAxis, QCPAxis* valueAxis, int capacity );
+
+	const QStreamBuffer& data() const { return data_; }
+	void setCapacity( int capacity ) { data_.setCapacity( capacity ); }
+	void addData( double key, double value ) { data_.push( key, value ); }
+	void removeDataBefore( double key ) { data_.expireBefore( key ); }
+
+	const QCPScatterStyle& scatterStyle() const { return scatterStyle_; }
+	void setScatterStyle( const QCPScatterStyle& style ) { scatterStyle_ = style; }
+
+	virtual void clearData() override { data_.clear(); }
+	virtual double selectTest( const QPointF& pos, bool onlySelectable, QVariant* details = 0 ) const override;
+
+protected:
+	virtual void draw( QCPPainter* painter ) override;
+	virtual void drawLegendIcon( QCPPainter* painter, const QRectF& rect ) const override;
+	virtual QCPRange getKeyRange( bool& foundRange, SignDomain inSignDomain = sdBoth ) const override;
+	virtual QCPRange getValueRange( bool& foundRange, SignDomain inSignDomain = sdBoth ) const override;
+
+private:
+	QPointF toPixels( double key, double value ) const;
+
+	QStreamBuffer data_;
+	QCPScatterStyle scatterStyle_;
+	QVector< QPointF > lineData_;
+};
@@ -0,0 +1,245 @@
+// headless benchmark of the plotting hot paths of QCustomPlot and QDataAnalysisView, writes CSV to stdout
+// usage: qtfx_bench [max_points]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+#include "qcustomplot/qcustomplot.h"
+#include "QDataAnalysisModel.h"
+#include "QDataAnalysisView.h"
+
+#include "xo/container/storage.h"
+
+namespace
+{
+	// storage with a time channel followed by channelCount smooth, noisy signals
+	struct SyntheticData
+	{
+		SyntheticData( int frameCount, int channelCount ) : model( &sto )
+		{
+			sto.add_channel( "time" );
+			for ( int c = 0; c < channelCount; ++c )
+			{
+				char label[ 32 ];
+				std::snprintf( label, sizeof( label ), "ch%05d", c );
+				sto.add_channel( label );
+			}
+
+			const double dt = 0.001;
+			unsigned int noise = 12345;
+			for ( int f = 0; f < frameCount; ++f )
+			{
+				sto.add_frame();
+				sto( f, 0 ) = float( f * dt );
+				for ( int c = 1; c <= channelCount; ++c )
+				{
+					noise = noise * 1664525u + 1013904223u;
+					sto( f, c ) = float( std::sin( f * dt * ( 1 + c % 7 ) ) + c % 3 + 0.01 * ( noise >> 24 ) / 255.0 );
+				}
+			}
+		}
+
+		xo::storage< float > sto;
+		StorageDataAnalysisModel< float > model;
+	};
+
+	// runs finished pyramid tasks and the queued plot updates that follow them
+	void settle()
+	{
+		for ( int i = 0; i < 3; ++i )
+		{
+			QThreadPool::globalInstance()->waitForDone();
+			QCoreApplication::processEvents();
+		}
+	}
+
+	void report( const char* name, int points, int channels, std::vector< double > ms )
+	{
+		std::sort( ms.begin(), ms.end() );
+		std::printf( "%s,%d,%d,%d,%.4f,%.4f,%.4f\n", name, points, channels, int( ms.size() ), ms.front(), ms[ ms.size() / 2 ], ms.back() );
+		std::fflush( stdout );
+	}
+
+	// times runs calls of func, prepare is called before each run but not timed
+	void measure( const char* name, int points, int channels, int runs, const std::function< void() >& func, const std::function< void() >& prepare = {} )
+	{
+		std::vector< double > ms;
+		QElapsedTimer timer;
+		for ( int r = 0; r < runs; ++r )
+		{
+			if ( prepare )
+				prepare();
+			timer.start();
+			func();
+			ms.push_back( timer.nsecsElapsed() * 1e-6 );
+		}
+		report( name, points, channels, ms );
+	}
+
+	void showView( QDataAnalysisView& view )
+	{
+		view.resize( 1600, 900 );
+		view.show();
+		settle();
+	}
+
+	void benchmarkPlot( int points )
+	{
+		std::fprintf( stderr, "plot, %d points\n", points );
+		SyntheticData data( points, 1 );
+		const auto& m = data.model;
+		QDataAnalysisView view( data.model );
+		showView( view );
+
+		// the filter hides the time channel, so selectAll checks the single signal channel
+		view.setFilterText( "ch" );
+		measure( "addSeries", points, 1, 5, [&]() { view.selectAll(); settle(); }, [&]() { view.selectNone(); settle(); } );
+
+		const double mid = 0.5 * ( m.timeStart() + m.timeFinish() );
+		const double zoom = 0.05 * ( m.timeFinish() - m.timeStart() );
+		measure( "replot_full", points, 1, 20, [&]() { view.setRange( m.timeStart(), m.timeFinish() ); } );
+		measure( "replot_zoom", points, 1, 20, [&]() { view.setRange( mid - zoom, mid + zoom ); } );
+
+		view.setAutoFitVerticalAxis( true );
+		const QCPRange full( m.timeStart(), m.timeFinish() ), zoomed( mid - zoom, mid + zoom );
+		measure( "fitVerticalAxis_full", points, 1, 20, [&]() { view.rangeChanged( full, full ); } );
+		measure( "fitVerticalAxis_zoom", points, 1, 20, [&]() { view.rangeChanged( zoomed, zoomed ); } );
+		view.setAutoFitVerticalAxis( false );
+
+		// the first hold takes the snapshot of the series, the following ones reuse it
+		measure( "holdSeries", points, 1, 5, [&]() { view.holdSeries(); } );
+	}
+
+	// GUI thread cost of selecting many large channels at once, the pyramids are built afterwards
+	void benchmarkSelectAll( int points, int channels )
+	{
+		std::fprintf( stderr, "selectAll, %d points, %d channels\n", points, channels );
+		SyntheticData data( points, channels );
+		QDataAnalysisView view( data.model );
+		showView( view );
+
+		view.setFilterText( "ch" );
+		measure( "selectAll", points, channels, 5, [&]() { view.selectAll(); }, [&]() { settle(); view.selectNone(); settle(); } );
+		settle();
+	}
+
+	// replot with the full key range against 1% of it, for the plottables that cull to the visible keys
+	void benchmarkCulling( int points )
+	{
+		std::fprintf( stderr, "culling, %d points
+", points );
+		QVector< double > keys( points ), values( points ), open( points ), high( points ), low( points ), close( points );
+		for ( int i = 0; i < points; ++i )
+		{
+			keys[ i ] = i;
+			values[ i ] = std::sin( i * 0.001 ) + 0.1 * std::sin( i * 0.37 );
+			open[ i ] = values[ i ];
+			close[ i ] = std::sin( ( i + 1 ) * 0.001 ) + 0.1 * std::sin( ( i + 1 ) * 0.37 );
+			high[ i ] = std::max( open[ i ], close[ i ] ) + 0.05;
+			low[ i ] = std::min( open[ i ], close[ i ] ) - 0.05;
+		}
+
+		QCustomPlot plot;
+		plot.resize( 1600, 900 );
+		plot.show();
+		settle();
+
+		const double mid = 0.5 * points, visible = 0.01 * points;
+		auto run = [&]( const std::string& name, QCPAbstractPlottable* plottable ) {
+			plot.clearPlottables();
+			plot.addPlottable( plottable );
+			plot.yAxis->setRange( -1.5, 1.5 );
+			plot.xAxis->setRange( 0, points - 1 );
+			measure( ( name + "_full" ).c_str(), points, 1, 5, [&]() { plot.replot(); } );
+			plot.xAxis->setRange( mid - 0.5 * visible, mid + 0.5 * visible );
+			measure( ( name + "_1pct" ).c_str(), points, 1, 20, [&]() { plot.replot(); } );
+		};
+
+		auto* graph = new QCPGraph( plot.xAxis, plot.yAxis );
+		graph->setData( keys, values );
+		run( "cull_graph", graph );
+
+		// setData without t numbers the points in order, so the keys are ascending along the curve
+		auto* curve = new QCPCurve( plot.xAxis, plot.yAxis );
+		curve->setData( keys, values );
+		run( "cull_curve", curve );
+
+		auto* bars = new QCPBars( plot.xAxis, plot.yAxis );
+		bars->setWidth( 0.8 );
+		bars->setData( keys, values );
+		run( "cull_bars", bars );
+
+		auto* financial = new QCPFinancial( plot.xAxis, plot.yAxis );
+		financial->setWidth( 0.5 );
+		financial->setData( keys, open, high, low, close );
+		run( "cull_financial", financial );
+	}
+
+	void benchmarkFilter( int channels )
+	{
+		std::fprintf( stderr, "filter, %d channels\n", channels );
+		SyntheticData data( 100, channels );
+		QDataAnalysisView view( data.model );
+		showView( view );
+
+		// each keystroke is a sample
+		const QString typed = QString::asprintf( "ch%05d", channels / 2 );
+		std::vector< double > ms;
+		QElapsedTimer timer;
+		for ( int r = 0; r < 5; ++r )
+		{
+			for ( int i = 1; i <= typed.size(); ++i )
+			{
+				timer.start();
+				view.setFilterText( typed.left( i ) );
+				ms.push_back( timer.nsecsElapsed() * 1e-6 );
+			}
+			timer.start();
+			view.setFilterText( QString() );
+			ms.push_back( timer.nsecsElapsed() * 1e-6 );
+		}
+		report( "filter_typing", 100, channels, ms );
+	}
+
+	void benchmarkSetTime( int channels )
+	{
+		std::fprintf( stderr, "setTime, %d channels\n", channels );
+		const int frames = 1000;
+		SyntheticData data( frames, channels );
+		const auto& m = data.model;
+		QDataAnalysisView view( data.model );
+		showView( view );
+
+		int frame = 0;
+		measure( "setTime", frames, channels, 200, [&]() { view.setTime( m.timeValue( frame ), false ); }, [&]() { frame = ( frame + 7 ) % frames; } );
+		measure( "setTime_refresh", frames, channels, 200, [&]() { view.setTime( m.timeValue( frame ), true ); }, [&]() { frame = ( frame + 7 ) % frames; } );
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() )
+		qputenv( "QT_QPA_PLATFORM", "offscreen" );
+	QApplication app( argc, argv );
+
+	const int maxPoints = argc > 1 ? std::atoi( argv[ 1 ] ) : 10000000;
+
+	std::printf( "benchmark,points,channels,runs,min_ms,median_ms,max_ms\n" );
+	for ( int points = 10000; points <= maxPoints; points *= 10 )
+		benchmarkPlot( points );
+	benchmarkSelectAll( std::min( maxPoints, 1000000 ), 32 );
+	benchmarkCulling( std::min( maxPoints, 1000000 ) );
+	benchmarkFilter( 20000 );
+	benchmarkSetTime( 5000 );
+
+	return 0;
+}
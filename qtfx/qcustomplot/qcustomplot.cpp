@@ -25,6 +25,268 @@
 
 #include "qcustomplot.h"
 
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QMutex>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define QCP_KERNELS_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#    define QCP_TARGET_AVX
+#  else
+#    define QCP_TARGET_AVX __attribute__((target("avx")))
+#  endif
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPKernels
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPKernels
+  \brief Vectorized kernels for the coordinate transform and decimation hot paths
+  
+  All kernels are static. The instruction set is determined once from the CPU features and can be
+  lowered with \ref setInstructionSet. The vectorized paths perform the same operations on each
+  element as the scalar path, so results only differ if the compiler contracts the scalar code.
+  
+  NaN values are ignored by \ref minMax, unless the first value is NaN, in which case both \a min and
+  \a max stay NaN. This matches the comparison based loops the kernels replace.
+*/
+
+namespace {
+
+QCPKernels::InstructionSet detectInstructionSet()
+{
+#ifdef QCP_KERNELS_X86
+#  if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (osxsave && avx && (_xgetbv(0) & 6) == 6) // OS saves the ymm registers
+    return QCPKernels::isAvx;
+#  else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx"))
+    return QCPKernels::isAvx;
+#  endif
+  return QCPKernels::isSse2;
+#else
+  return QCPKernels::isScalar;
+#endif
+}
+
+QCPKernels::InstructionSet &currentInstructionSet()
+{
+  static QCPKernels::InstructionSet instructionSet = detectInstructionSet();
+  return instructionSet;
+}
+
+#ifdef QCP_KERNELS_X86
+void linearTransformSse2(const double *in, double *out, int count, const QCPLinearTransform &t)
+{
+  const __m128d c = _mm_set1_pd(t.origin), s = _mm_set1_pd(t.scale), o = _mm_set1_pd(t.offset);
+  int i = 0;
+  for (; i+2 <= count; i += 2)
+    _mm_storeu_pd(out+i, _mm_add_pd(_mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(in+i), c), s), o));
+  for (; i < count; ++i)
+    out[i] = (in[i]-t.origin)*t.scale+t.offset;
+}
+
+QCP_TARGET_AVX void linearTransformAvx(const double *in, double *out, int count, const QCPLinearTransform &t)
+{
+  const __m256d c = _mm256_set1_pd(t.origin), s = _mm256_set1_pd(t.scale), o = _mm256_set1_pd(t.offset);
+  int i = 0;
+  for (; i+4 <= count; i += 4)
+    _mm256_storeu_pd(out+i, _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(in+i), c), s), o));
+  _mm256_zeroupper();
+  for (; i < count; ++i)
+    out[i] = (in[i]-t.origin)*t.scale+t.offset;
+}
+
+void linearTransformPairsSse2(const double *in, int inStride, double *out, int count, const QCPLinearTransform &t0, const QCPLinearTransform &t1, bool swapped)
+{
+  const __m128d c = _mm_setr_pd(t0.origin, t1.origin), s = _mm_setr_pd(t0.scale, t1.scale), o = _mm_setr_pd(t0.offset, t1.offset);
+  for (int i=0; i<count; ++i, in += inStride)
+  {
+    __m128d v = _mm_loadu_pd(in);
+    if (swapped)
+      v = _mm_shuffle_pd(v, v, 1);
+    _mm_storeu_pd(out+2*i, _mm_add_pd(_mm_mul_pd(_mm_sub_pd(v, c), s), o));
+  }
+}
+
+QCP_TARGET_AVX void linearTransformPairsAvx(const double *in, int inStride, double *out, int count, const QCPLinearTransform &t0, const QCPLinearTransform &t1, bool swapped)
+{
+  const __m256d c = _mm256_setr_pd(t0.origin, t1.origin, t0.origin, t1.origin);
+  const __m256d s = _mm256_setr_pd(t0.scale, t1.scale, t0.scale, t1.scale);
+  const __m256d o = _mm256_setr_pd(t0.offset, t1.offset, t0.offset, t1.offset);
+  int i = 0;
+  for (; i+2 <= count; i += 2, in += 2*inStride)
+  {
+    __m256d v = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(in)), _mm_loadu_pd(in+inStride), 1);
+    if (swapped)
+      v = _mm256_permute_pd(v, 5);
+    _mm256_storeu_pd(out+2*i, _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(v, c), s), o));
+  }
+  _mm256_zeroupper();
+  if (i < count)
+    linearTransformPairsSse2(in, inStride, out+2*i, count-i, t0, t1, swapped);
+}
+
+// the accumulator is always the second operand, so NaN values are skipped like in the scalar path
+void minMaxSse2(const double *values, int stride, int count, double &min, double &max)
+{
+  __m128d mn = _mm_set1_pd(values[0]), mx = mn;
+  int i = 0;
+  for (; i+2 <= count; i += 2)
+  {
+    __m128d v = stride == 1 ? _mm_loadu_pd(values+i) : _mm_setr_pd(values[i*stride], values[(i+1)*stride]);
+    mn = _mm_min_pd(v, mn);
+    mx = _mm_max_pd(v, mx);
+  }
+  mn = _mm_min_sd(_mm_unpackhi_pd(mn, mn), mn);
+  mx = _mm_max_sd(_mm_unpackhi_pd(mx, mx), mx);
+  min = _mm_cvtsd_f64(mn);
+  max = _mm_cvtsd_f64(mx);
+  for (; i < count; ++i)
+  {
+    double v = values[i*stride];
+    min = v < min ? v : min;
+    max = v > max ? v : max;
+  }
+}
+
+QCP_TARGET_AVX void minMaxAvx(const double *values, int stride, int count, double &min, double &max)
+{
+  __m256d mn = _mm256_set1_pd(values[0]), mx = mn;
+  int i = 0;
+  for (; i+4 <= count; i += 4)
+  {
+    __m256d v = stride == 1 ? _mm256_loadu_pd(values+i) : _mm256_setr_pd(values[i*stride], values[(i+1)*stride], values[(i+2)*stride], values[(i+3)*stride]);
+    mn = _mm256_min_pd(v, mn);
+    mx = _mm256_max_pd(v, mx);
+  }
+  __m128d mn2 = _mm_min_pd(_mm256_extractf128_pd(mn, 1), _mm256_castpd256_pd128(mn));
+  __m128d mx2 = _mm_max_pd(_mm256_extractf128_pd(mx, 1), _mm256_castpd256_pd128(mx));
+  _mm256_zeroupper();
+  mn2 = _mm_min_sd(_mm_unpackhi_pd(mn2, mn2), mn2);
+  mx2 = _mm_max_sd(_mm_unpackhi_pd(mx2, mx2), mx2);
+  min = _mm_cvtsd_f64(mn2);
+  max = _mm_cvtsd_f64(mx2);
+  for (; i < count; ++i)
+  {
+    double v = values[i*stride];
+    min = v < min ? v : min;
+    max = v > max ? v : max;
+  }
+}
+#endif
+
+} // namespace
+
+/*!
+  Returns the instruction set the kernels currently use.
+*/
+QCPKernels::InstructionSet QCPKernels::instructionSet()
+{
+  return currentInstructionSet();
+}
+
+/*!
+  Returns the best instruction set supported by the CPU and the build.
+*/
+QCPKernels::InstructionSet QCPKernels::supportedInstructionSet()
+{
+  static InstructionSet supported = detectInstructionSet();
+  return supported;
+}
+
+/*!
+  Sets the instruction set the kernels use. Sets higher than \ref supportedInstructionSet are
+  lowered to the supported one. Not thread safe, call this before any plotting takes place.
+*/
+void QCPKernels::setInstructionSet(QCPKernels::InstructionSet instructionSet)
+{
+  currentInstructionSet() = qMin(instructionSet, supportedInstructionSet());
+}
+
+/*!
+  Writes <tt>(in[i]-t.origin)*t.scale+t.offset</tt> to \a out for \a count values. \a in and \a
+  out may be the same array.
+*/
+void QCPKernels::linearTransform(const double *in, double *out, int count, const QCPLinearTransform &t)
+{
+#ifdef QCP_KERNELS_X86
+  switch (currentInstructionSet())
+  {
+    case isAvx: linearTransformAvx(in, out, count, t); return;
+    case isSse2: linearTransformSse2(in, out, count, t); return;
+    case isScalar: break;
+  }
+#endif
+  for (int i=0; i<count; ++i)
+    out[i] = (in[i]-t.origin)*t.scale+t.offset;
+}
+
+/*!
+  Transforms \a count pairs of values, the first pair starting at \a in and each next pair \a
+  inStride doubles further. The results are written as consecutive pairs to \a out, which must hold
+  <tt>2*count</tt> doubles (e.g. a QPointF array). The first value of each output pair is a
+  transformed by \a t0, the second b transformed by \a t1, where (a, b) is the input pair, or the
+  input pair with swapped elements if \a swapped is true.
+  
+  This transforms the key and value of \ref QCPData points to pixel coordinates in one pass.
+*/
+void QCPKernels::linearTransformPairs(const double *in, int inStride, double *out, int count, const QCPLinearTransform &t0, const QCPLinearTransform &t1, bool swapped)
+{
+#ifdef QCP_KERNELS_X86
+  switch (currentInstructionSet())
+  {
+    case isAvx: linearTransformPairsAvx(in, inStride, out, count, t0, t1, swapped); return;
+    case isSse2: linearTransformPairsSse2(in, inStride, out, count, t0, t1, swapped); return;
+    case isScalar: break;
+  }
+#endif
+  for (int i=0; i<count; ++i, in += inStride)
+  {
+    double a = swapped ? in[1] : in[0];
+    double b = swapped ? in[0] : in[1];
+    out[2*i] = (a-t0.origin)*t0.scale+t0.offset;
+    out[2*i+1] = (b-t1.origin)*t1.scale+t1.offset;
+  }
+}
+
+/*!
+  Determines the smallest and largest of \a count values, which are \a stride doubles apart.
+  \a count must be at least one.
+*/
+void QCPKernels::minMax(const double *values, int stride, int count, double &min, double &max)
+{
+#ifdef QCP_KERNELS_X86
+  switch (currentInstructionSet())
+  {
+    case isAvx: minMaxAvx(values, stride, count, min, max); return;
+    case isSse2: minMaxSse2(values, stride, count, min, max); return;
+    case isScalar: break;
+  }
+#endif
+  min = max = values[0];
+  for (int i=1; i<count; ++i)
+  {
+    double v = values[i*stride];
+    min = v < min ? v : min;
+    max = v > max ? v : max;
+  }
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -536,6 +798,92 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, QPointF pos) const
   drawShape(painter, pos.x(), pos.y());
 }
 
+/*!
+  Draws the scatter shape with \a painter at all \a positions. Positions with NaN coordinates are
+  skipped. Like \ref drawShape, this uses the pen and brush that were set with \ref applyTo.
+  
+  When painting on a raster device, the shape is rasterized once into a glyph image, which is then
+  blitted at each position. Glyphs are cached per shape, size, pen, brush, antialiasing and device
+  pixel ratio, so scatter plots with many points cost little more than their line plots. The
+  positions are rounded to whole device pixels in that case. Vectorized painting, transformed
+  painters, pixmap and custom shapes, and brushes other than solid ones draw each shape with \ref
+  drawShape instead.
+  
+  \see applyTo
+*/
+void QCPScatterStyle::drawShapes(QCPPainter *painter, const QVector<QPointF> &positions) const
+{
+  bool useGlyph = mShape != ssNone && mShape != ssDot && mShape != ssPixmap && mShape != ssCustom &&
+      !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+      painter->transform().type() <= QTransform::TxTranslate &&
+      (painter->brush().style() == Qt::NoBrush || painter->brush().style() == Qt::SolidPattern) &&
+      painter->pen().brush().style() == Qt::SolidPattern;
+  if (!useGlyph)
+  {
+    for (int i=0; i<positions.size(); ++i)
+    {
+      if (!qIsNaN(positions.at(i).x()) && !qIsNaN(positions.at(i).y()))
+        drawShape(painter, positions.at(i));
+    }
+    return;
+  }
+  
+  double dpr = painter->device()->devicePixelRatioF();
+  int center; // glyph center in device pixels
+  QImage glyph = cachedGlyph(painter, dpr, center);
+  for (int i=0; i<positions.size(); ++i)
+  {
+    const QPointF &pos = positions.at(i);
+    if (qIsNaN(pos.x()) || qIsNaN(pos.y()))
+      continue;
+    painter->drawImage(QPointF((qRound(pos.x()*dpr)-center)/dpr, (qRound(pos.y()*dpr)-center)/dpr), glyph);
+  }
+}
+
+/*! \internal
+  
+  Returns the glyph image of this scatter style, drawn with the pen, brush and antialiasing of \a
+  painter at \a devicePixelRatio. \a center is set to the position of the shape center in the
+  image, in device pixels. Glyphs are kept in a cache that is shared between all scatter styles and
+  threads.
+*/
+QImage QCPScatterStyle::cachedGlyph(QCPPainter *painter, double devicePixelRatio, int &center) const
+{
+  static QMutex cacheMutex;
+  static QCache<QString, QImage> cache(4*1024*1024); // cost is the image size in bytes
+  
+  const QPen &pen = painter->pen();
+  const QBrush &brush = painter->brush();
+  double penWidth = pen.style() == Qt::NoPen ? 0 : qMax(1.0, pen.widthF());
+  center = qCeil((mSize+penWidth)*0.5*devicePixelRatio)+1;
+  QString key = QString::number(mShape)+QLatin1Char(' ')+QString::number(mSize)+QLatin1Char(' ')+
+      QString::number(pen.color().rgba())+QLatin1Char(' ')+QString::number(pen.widthF())+QLatin1Char(' ')+
+      QString::number(pen.style())+QLatin1Char(' ')+QString::number(pen.isCosmetic())+QLatin1Char(' ')+
+      QString::number(brush.color().rgba())+QLatin1Char(' ')+QString::number(brush.style())+QLatin1Char(' ')+
+      QString::number(painter->antialiasing())+QLatin1Char(' ')+QString::number(devicePixelRatio);
+  
+  QMutexLocker locker(&cacheMutex);
+  if (QImage *cached = cache.object(key))
+    return *cached;
+  
+  QImage glyph(2*center+1, 2*center+1, QImage::Format_ARGB32_Premultiplied);
+  glyph.fill(Qt::transparent);
+  glyph.setDevicePixelRatio(devicePixelRatio);
+  QCPPainter glyphPainter(&glyph);
+  glyphPainter.setModes(painter->modes());
+  glyphPainter.setAntialiasing(painter->antialiasing());
+  glyphPainter.setPen(pen);
+  glyphPainter.setBrush(brush);
+  drawShape(&glyphPainter, center/devicePixelRatio, center/devicePixelRatio);
+  glyphPainter.end();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+  cache.insert(key, new QImage(glyph), int(glyph.sizeInBytes()));
+#else
+  cache.insert(key, new QImage(glyph), glyph.byteCount());
+#endif
+  return glyph;
+}
+
 /*! \overload
   Draws the scatter shape with \a painter at position \a x and \a y.
 */
@@ -741,7 +1089,8 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
-  mVisible(true)
+  mVisible(true),
+  mMode(lmLogical)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -774,6 +1123,38 @@ void QCPLayer::setVisible(bool visible)
   mVisible = visible;
 }
 
+/*!
+  Sets how this layer is buffered. Layers in \ref lmLogical mode (the default) are drawn into a paint
+  buffer shared with adjacent logical layers. A layer in \ref lmBuffered mode has its own paint
+  buffer, so it can be redrawn with \ref replot without redrawing any other layer. This is useful
+  for layers with frequently changing content, like a cursor item on top of expensive plottables.
+  
+  The change takes effect with the next \ref QCustomPlot::replot.
+*/
+void QCPLayer::setMode(QCPLayer::LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    mPaintBuffer = QImage();
+    mParentPlot->mLayerBuffersValid = false;
+  }
+}
+
+/*!
+  Redraws only this layer, if it is in \ref lmBuffered mode. The other layers are composited from
+  the paint buffers of the last \ref QCustomPlot::replot, so they don't reflect changes made since.
+  For layers in \ref lmLogical mode, or if no complete replot has been done yet with the current
+  layers, this performs a full \ref QCustomPlot::replot.
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmBuffered && mParentPlot->mLayerBuffersValid)
+    mParentPlot->replotLayer(this);
+  else
+    mParentPlot->replot();
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -5318,6 +5699,56 @@ double QCPAxis::pixelToCoord(double value) const
   }
 }
 
+/*!
+  Transforms \a count values in \a coords, in coordinates of the axis, to pixel coordinates of the
+  QCustomPlot widget and writes them to \a pixels. For linear axes, this uses the vectorized \ref
+  QCPKernels::linearTransform, otherwise \ref coordToPixel is called for each value.
+*/
+void QCPAxis::coordsToPixels(const double *coords, double *pixels, int count) const
+{
+  QCPLinearTransform transform;
+  if (getLinearTransform(transform))
+    QCPKernels::linearTransform(coords, pixels, count, transform);
+  else
+  {
+    for (int i=0; i<count; ++i)
+      pixels[i] = coordToPixel(coords[i]);
+  }
+}
+
+/*!
+  If the axis has a linear scale, sets \a transform such that <tt>(coord-origin)*scale+offset</tt>
+  is the pixel coordinate of \a coord, and returns true. Returns false for logarithmic axes.
+  
+  The origin is the range boundary at which the axis starts, so the subtraction happens before the
+  scaling like in \ref coordToPixel. This keeps full precision for large coordinates in small
+  ranges, e.g. date time axes zoomed to milliseconds.
+  
+  \see coordToPixel, QCPKernels::linearTransform
+*/
+bool QCPAxis::getLinearTransform(QCPLinearTransform &transform) const
+{
+  if (mScaleType != stLinear)
+    return false;
+  if (orientation() == Qt::Horizontal)
+  {
+    transform.scale = mAxisRect->width()/mRange.size();
+    transform.offset = mAxisRect->left();
+  } else
+  {
+    transform.scale = -mAxisRect->height()/mRange.size();
+    transform.offset = mAxisRect->bottom();
+  }
+  if (!mRangeReversed)
+    transform.origin = mRange.lower;
+  else
+  {
+    transform.origin = mRange.upper;
+    transform.scale = -transform.scale;
+  }
+  return true;
+}
+
 /*!
   Transforms \a value, in coordinates of the axis, to pixel coordinates of the QCustomPlot widget.
 */
@@ -5570,8 +6001,26 @@ void QCPAxis::setupTickVectors()
     mTickVectorLabels.resize(vecsize);
     if (mTickLabelType == ltNumber)
     {
+      // when the range is only shifted (e.g. while dragging), most ticks keep their value, so their
+      // labels are taken from the previous tick vector instead of being formatted again:
+      QByteArray labelFormat = mParentPlot->locale().name().toLatin1() + QByteArray::number((int)mParentPlot->locale().numberOptions()) + mNumberFormatChar.toLatin1() + QByteArray::number(mNumberPrecision);
+      int shift = 0;
+      bool reuse = labelFormat == mPreviousLabelFormat && !mPreviousTickVector.isEmpty() && mLowestVisibleTick <= mHighestVisibleTick;
+      if (reuse)
+        shift = std::lower_bound(mPreviousTickVector.constBegin(), mPreviousTickVector.constEnd(), mTickVector.at(mLowestVisibleTick))-mPreviousTickVector.constBegin() - mLowestVisibleTick;
       for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
-        mTickVectorLabels[i] = mParentPlot->locale().toString(mTickVector.at(i), mNumberFormatChar.toLatin1(), mNumberPrecision);
+      {
+        int k = i+shift;
+        if (reuse && k >= 0 && k < mPreviousTickVector.size() && mPreviousTickVector.at(k) == mTickVector.at(i))
+          mTickVectorLabels[i] = mPreviousTickVectorLabels.at(k);
+        else
+          mTickVectorLabels[i] = mParentPlot->locale().toString(mTickVector.at(i), mNumberFormatChar.toLatin1(), mNumberPrecision);
+      }
+      // only the visible part of the label vector holds valid labels:
+      int visibleCount = qMax(0, mHighestVisibleTick-mLowestVisibleTick+1);
+      mPreviousTickVector = mTickVector.mid(mLowestVisibleTick, visibleCount);
+      mPreviousTickVectorLabels = mTickVectorLabels.mid(mLowestVisibleTick, visibleCount);
+      mPreviousLabelFormat = labelFormat;
     } else if (mTickLabelType == ltDateTime)
     {
       for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
@@ -6080,7 +6529,9 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   abbreviateDecimalPowers(false),
   reversedEndings(false),
   mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mLabelCache(64), // cache at most 64 (tick) labels
+  mLabelSizeCache(256),
+  mCachedLabelHeight(-1)
 {
 }
 
@@ -6302,6 +6753,12 @@ int QCPAxisPainterPrivate::size() const
     QSize tickLabelsSize(0, 0);
     if (!tickLabels.isEmpty())
     {
+      QByteArray newHash = generateLabelParameterHash();
+      if (newHash != mLabelSizeParameterHash) // measured sizes depend on font, rotation etc.
+      {
+        mLabelSizeCache.clear();
+        mLabelSizeParameterHash = newHash;
+      }
       for (int i=0; i<tickLabels.size(); ++i)
         getMaxTickLabelSize(tickLabelFont, tickLabels.at(i), &tickLabelsSize);
       result += QCPAxis::orientation(type) == Qt::Horizontal ? tickLabelsSize.height() : tickLabelsSize.width();
@@ -6312,10 +6769,16 @@ int QCPAxisPainterPrivate::size() const
   // calculate size of axis label (only height needed, because left/right labels are rotated by 90 degrees):
   if (!label.isEmpty())
   {
-    QFontMetrics fontMetrics(labelFont);
-    QRect bounds;
-    bounds = fontMetrics.boundingRect(0, 0, 0, 0, Qt::TextDontClip | Qt::AlignHCenter | Qt::AlignVCenter, label);
-    result += bounds.height() + labelPadding;
+    if (mCachedLabelHeight < 0 || label != mCachedLabelText || labelFont != mCachedLabelFont)
+    {
+      QFontMetrics fontMetrics(labelFont);
+      QRect bounds;
+      bounds = fontMetrics.boundingRect(0, 0, 0, 0, Qt::TextDontClip | Qt::AlignHCenter | Qt::AlignVCenter, label);
+      mCachedLabelText = label;
+      mCachedLabelFont = labelFont;
+      mCachedLabelHeight = bounds.height();
+    }
+    result += mCachedLabelHeight + labelPadding;
   }
   
   return result;
@@ -6330,6 +6793,7 @@ int QCPAxisPainterPrivate::size() const
 void QCPAxisPainterPrivate::clearCache()
 {
   mLabelCache.clear();
+  mLabelSizeCache.clear();
 }
 
 /*! \internal
@@ -6672,10 +7136,15 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
   {
     const CachedLabel *cachedLabel = mLabelCache.object(text);
     finalSize = cachedLabel->pixmap.size();
+  } else if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelSizeCache.contains(text)) // label was measured before, but isn't drawn yet
+  {
+    finalSize = *mLabelSizeCache.object(text);
   } else // label caching disabled or no label with this text cached:
   {
     TickLabelData labelData = getTickLabelData(font, text);
     finalSize = labelData.rotatedTotalBounds.size();
+    if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels))
+      mLabelSizeCache.insert(text, new QSize(finalSize));
   }
   
   // expand passed tickLabelsSize if current tick label is larger:
@@ -9036,7 +9505,9 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mMultiSelectModifier(Qt::ControlModifier),
   mPaintBuffer(size()),
   mMouseEventElement(0),
-  mReplotting(false)
+  mReplotting(false),
+  mRenderThreadPool(0),
+  mLayerBuffersValid(false)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -10097,6 +10568,7 @@ bool QCustomPlot::addLayer(const QString &name, QCPLayer *otherLayer, QCustomPlo
     
   QCPLayer *newLayer = new QCPLayer(this, name);
   mLayers.insert(otherLayer->index() + (insertMode==limAbove ? 1:0), newLayer);
+  mLayerBuffersValid = false;
   updateLayerIndices();
   return true;
 }
@@ -10148,6 +10620,7 @@ bool QCustomPlot::removeLayer(QCPLayer *layer)
   // remove layer:
   delete layer;
   mLayers.removeOne(layer);
+  mLayerBuffersValid = false;
   updateLayerIndices();
   return true;
 }
@@ -10179,6 +10652,7 @@ bool QCustomPlot::moveLayer(QCPLayer *layer, QCPLayer *otherLayer, QCustomPlot::
   else if (layer->index() < otherLayer->index())
     mLayers.move(layer->index(), otherLayer->index() + (insertMode==limAbove ? 0:-1));
   
+  mLayerBuffersValid = false;
   updateLayerIndices();
   return true;
 }
@@ -10378,7 +10852,10 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
     if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
       painter.fillRect(mViewport, mBackgroundBrush);
-    draw(&painter);
+    if (hasBufferedLayers())
+      drawBuffered(&painter, 0);
+    else
+      draw(&painter);
     painter.end();
     if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
       repaint();
@@ -10882,20 +11359,7 @@ void QCustomPlot::draw(QCPPainter *painter)
   drawBackground(painter);
 
   // draw all layered objects (grid, axes, plottables, items, legend,...):
-  foreach (QCPLayer *layer, mLayers)
-  {
-    foreach (QCPLayerable *child, layer->children())
-    {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
-  }
+  drawLayers(painter, mLayers);
   
   /* Debug code to draw all layout element rects
   foreach (QCPLayoutElement* el, findChildren<QCPLayoutElement*>())
@@ -10911,81 +11375,324 @@ void QCustomPlot::draw(QCPPainter *painter)
 
 /*! \internal
   
-  Draws the viewport background pixmap of the plot.
-  
-  If a pixmap was provided via \ref setBackground, this function buffers the scaled version
-  depending on \ref setBackgroundScaled and \ref setBackgroundScaledMode and then draws it inside
-  the viewport with the provided \a painter. The scaled version is buffered in
-  mScaledBackgroundPixmap to prevent expensive rescaling at every redraw. It is only updated, when
-  the axis rect has changed in a way that requires a rescale of the background pixmap (this is
-  dependent on the \ref setBackgroundScaledMode), or when a differend axis background pixmap was
-  set.
-  
-  Note that this function does not draw a fill with the background brush (\ref setBackground(const
-  QBrush &brush)) beneath the pixmap.
-  
-  \see setBackground, setBackgroundScaled, setBackgroundScaledMode
+  Returns whether \a plottable can be rasterized on a worker thread with \ref
+  QCP::phParallelRendering. QPixmap may only be used on the GUI thread, so plottables that draw
+  pixmap scatters or use a textured pen or brush are drawn serially.
 */
-void QCustomPlot::drawBackground(QCPPainter *painter)
+static bool isParallelDrawable(const QCPAbstractPlottable *plottable)
 {
-  // Note: background color is handled in individual replot/save functions
-
-  // draw background pixmap (on top of fill, if brush specified):
-  if (!mBackgroundPixmap.isNull())
-  {
-    if (mBackgroundScaled)
-    {
-      // check whether mScaledBackground needs to be updated:
-      QSize scaledSize(mBackgroundPixmap.size());
-      scaledSize.scale(mViewport.size(), mBackgroundScaledMode);
-      if (mScaledBackgroundPixmap.size() != scaledSize)
-        mScaledBackgroundPixmap = mBackgroundPixmap.scaled(mViewport.size(), mBackgroundScaledMode, Qt::SmoothTransformation);
-      painter->drawPixmap(mViewport.topLeft(), mScaledBackgroundPixmap, QRect(0, 0, mViewport.width(), mViewport.height()) & mScaledBackgroundPixmap.rect());
-    } else
-    {
-      painter->drawPixmap(mViewport.topLeft(), mBackgroundPixmap, QRect(0, 0, mViewport.width(), mViewport.height()));
-    }
-  }
+  const QPen pen = plottable->selected() ? plottable->selectedPen() : plottable->pen();
+  const QBrush brush = plottable->selected() ? plottable->selectedBrush() : plottable->brush();
+  if (brush.style() == Qt::TexturePattern || pen.brush().style() == Qt::TexturePattern)
+    return false;
+  
+  QCPScatterStyle::ScatterShape shape = QCPScatterStyle::ssNone;
+  if (const QCPGraph *graph = qobject_cast<const QCPGraph*>(plottable))
+    shape = graph->scatterStyle().shape();
+  else if (const QCPCompactGraph *compactGraph = qobject_cast<const QCPCompactGraph*>(plottable))
+    shape = compactGraph->scatterStyle().shape();
+  else if (const QCPCurve *curve = qobject_cast<const QCPCurve*>(plottable))
+    shape = curve->scatterStyle().shape();
+  else if (const QCPStatisticalBox *box = qobject_cast<const QCPStatisticalBox*>(plottable))
+    shape = box->outlierStyle().shape();
+  return shape != QCPScatterStyle::ssPixmap;
 }
 
-
 /*! \internal
   
-  This method is used by \ref QCPAxisRect::removeAxis to report removed axes to the QCustomPlot
-  so it may clear its QCustomPlot::xAxis, yAxis, xAxis2 and yAxis2 members accordingly.
+  Draws the children of \a layers in order with \a painter.
 */
-void QCustomPlot::axisRemoved(QCPAxis *axis)
+void QCustomPlot::drawLayers(QCPPainter *painter, const QList<QCPLayer*> &layers)
 {
-  if (xAxis == axis)
-    xAxis = 0;
-  if (xAxis2 == axis)
-    xAxis2 = 0;
-  if (yAxis == axis)
-    yAxis = 0;
-  if (yAxis2 == axis)
-    yAxis2 = 0;
+  // with parallel rendering, consecutive plottables are collected and rasterized concurrently
+  const bool parallel = mPlottingHints.testFlag(QCP::phParallelRendering) && !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+      painter->device() && (painter->device()->devType() == QInternal::Pixmap || painter->device()->devType() == QInternal::Image);
+  QList<QCPLayerable*> plottableBatch;
   
-  // Note: No need to take care of range drag axes and range zoom axes, because they are stored in smart pointers
+  foreach (QCPLayer *layer, layers)
+  {
+    foreach (QCPLayerable *child, layer->children())
+    {
+      if (child->realVisibility())
+      {
+        QCPAbstractPlottable *plottable = parallel ? qobject_cast<QCPAbstractPlottable*>(child) : 0;
+        if (plottable && isParallelDrawable(plottable))
+        {
+          plottableBatch.append(child);
+          continue;
+        }
+        if (!plottableBatch.isEmpty())
+        {
+          drawLayerablesParallel(painter, plottableBatch);
+          plottableBatch.clear();
+        }
+        drawLayerable(painter, child);
+      }
+    }
+  }
+  if (!plottableBatch.isEmpty())
+    drawLayerablesParallel(painter, plottableBatch);
 }
 
 /*! \internal
   
-  This method is used by the QCPLegend destructor to report legend removal to the QCustomPlot so
-  it may clear its QCustomPlot::legend member accordingly.
+  Returns whether any layer is in \ref QCPLayer::lmBuffered mode.
 */
-void QCustomPlot::legendRemoved(QCPLegend *legend)
+bool QCustomPlot::hasBufferedLayers() const
 {
-  if (this->legend == legend)
-    this->legend = 0;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mode() == QCPLayer::lmBuffered)
+      return true;
+  }
+  return false;
 }
 
 /*! \internal
   
-  Assigns all layers their index (QCPLayer::mIndex) in the mLayers list. This method is thus called
-  after every operation that changes the layer indices, like layer removal, layer creation, layer
-  moving.
+  Draws the plot with \a painter using the layer paint buffers. Each layer in \ref
+  QCPLayer::lmBuffered mode has its own buffer, each run of adjacent \ref QCPLayer::lmLogical layers
+  shares one. If \a onlyLayer is 0, the layout is updated and all buffers are redrawn. Otherwise,
+  only the buffer of \a onlyLayer is redrawn and the others are reused. Finally, the background and
+  all buffers are composited in layer order.
 */
-void QCustomPlot::updateLayerIndices() const
+void QCustomPlot::drawBuffered(QCPPainter *painter, QCPLayer *onlyLayer)
+{
+  if (!onlyLayer)
+  {
+    mPlotLayout->update(QCPLayoutElement::upPreparation);
+    mPlotLayout->update(QCPLayoutElement::upMargins);
+    mPlotLayout->update(QCPLayoutElement::upLayout);
+  }
+  
+  // split the layers into buffered layers and runs of logical layers:
+  QList<QList<QCPLayer*> > segments;
+  for (int i=0; i<mLayers.size(); ++i)
+  {
+    if (mLayers.at(i)->mode() == QCPLayer::lmBuffered || i == 0 || mLayers.at(i-1)->mode() == QCPLayer::lmBuffered)
+      segments.append(QList<QCPLayer*>());
+    segments.last().append(mLayers.at(i));
+  }
+  int logicalCount = 0;
+  foreach (const QList<QCPLayer*> &segment, segments)
+  {
+    if (segment.first()->mode() == QCPLayer::lmLogical)
+      ++logicalCount;
+  }
+  if (mLogicalLayerBuffers.size() != logicalCount)
+    mLogicalLayerBuffers.resize(logicalCount);
+  
+  const QSize size(painter->device()->width(), painter->device()->height());
+  int logicalIndex = 0;
+  QList<QImage*> buffers;
+  foreach (const QList<QCPLayer*> &segment, segments)
+  {
+    QImage *buffer = segment.first()->mode() == QCPLayer::lmBuffered ? &segment.first()->mPaintBuffer : &mLogicalLayerBuffers[logicalIndex++];
+    buffers.append(buffer);
+    if (onlyLayer && segment.first() != onlyLayer)
+      continue;
+    
+    if (buffer->size() != size)
+      *buffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    buffer->fill(Qt::transparent);
+    QCPPainter bufferPainter(buffer);
+    bufferPainter.setRenderHints(painter->renderHints());
+    bufferPainter.setModes(painter->modes());
+    drawLayers(&bufferPainter, segment);
+  }
+  if (!onlyLayer)
+    mLayerBuffersValid = true;
+  
+  drawBackground(painter);
+  foreach (QImage *buffer, buffers)
+    painter->drawImage(0, 0, *buffer);
+}
+
+/*! \internal
+  
+  Redraws only \a layer and composites it with the buffers of the other layers. Called by \ref
+  QCPLayer::replot.
+*/
+void QCustomPlot::replotLayer(QCPLayer *layer)
+{
+  if (mReplotting)
+    return;
+  mReplotting = true;
+  
+  mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+      painter.fillRect(mViewport, mBackgroundBrush);
+    drawBuffered(&painter, layer);
+    painter.end();
+    update();
+  }
+  
+  mReplotting = false;
+}
+
+/*! \internal
+  
+  Draws a single \a layerable with \a painter, clipped to the clip rect of the layerable.
+*/
+void QCustomPlot::drawLayerable(QCPPainter *painter, QCPLayerable *layerable)
+{
+  painter->save();
+  painter->setClipRect(layerable->clipRect().translated(0, -1));
+  layerable->applyDefaultAntialiasingHint(painter);
+  layerable->draw(painter);
+  painter->restore();
+}
+
+namespace
+{
+  class QCPRenderRunnable : public QRunnable
+  {
+  public:
+    explicit QCPRenderRunnable(const std::function<void()> &func) : mFunc(func) {}
+    virtual void run() { mFunc(); }
+  private:
+    std::function<void()> mFunc;
+  };
+}
+
+/*! \internal
+  
+  Draws \a layerables, which must be in drawing order, with \ref QCP::phParallelRendering. The
+  layerables are split into contiguous chunks, one per core. Each chunk is rasterized into its own
+  transparent image buffer, the first chunk on the calling thread and the others on a thread pool
+  that is owned by the plot. The buffers are then composited onto \a painter in order, so the result
+  is the same as when drawing serially.
+*/
+void QCustomPlot::drawLayerablesParallel(QCPPainter *painter, const QList<QCPLayerable*> &layerables)
+{
+  const int chunkCount = qMin(layerables.size(), qMax(1, QThread::idealThreadCount()));
+  if (chunkCount < 2)
+  {
+    foreach (QCPLayerable *layerable, layerables)
+      drawLayerable(painter, layerable);
+    return;
+  }
+  
+  if (!mRenderThreadPool)
+  {
+    mRenderThreadPool = new QThreadPool(this);
+    mRenderThreadPool->setMaxThreadCount(qMax(1, QThread::idealThreadCount()-1));
+  }
+  if (mRenderBuffers.size() < chunkCount)
+    mRenderBuffers.resize(chunkCount);
+  
+  const QSize size(painter->device()->width(), painter->device()->height());
+  QImage *buffers = mRenderBuffers.data(); // obtained before the workers start, to avoid concurrent detach checks
+  auto renderChunk = [&](int chunk)
+  {
+    QImage &buffer = buffers[chunk];
+    if (buffer.size() != size)
+      buffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    buffer.fill(Qt::transparent);
+    QCPPainter chunkPainter(&buffer);
+    chunkPainter.setRenderHints(painter->renderHints());
+    chunkPainter.setModes(painter->modes());
+    chunkPainter.setTransform(painter->transform());
+    const int begin = layerables.size()*chunk/chunkCount;
+    const int end = layerables.size()*(chunk+1)/chunkCount;
+    for (int i=begin; i<end; ++i)
+      drawLayerable(&chunkPainter, layerables.at(i));
+  };
+  
+  for (int chunk=1; chunk<chunkCount; ++chunk)
+    mRenderThreadPool->start(new QCPRenderRunnable([&renderChunk, chunk]() { renderChunk(chunk); }));
+  renderChunk(0);
+  mRenderThreadPool->waitForDone();
+  
+  painter->save();
+  painter->resetTransform();
+  for (int chunk=0; chunk<chunkCount; ++chunk)
+    painter->drawImage(0, 0, buffers[chunk]);
+  painter->restore();
+}
+
+/*! \internal
+  
+  Draws the viewport background pixmap of the plot.
+  
+  If a pixmap was provided via \ref setBackground, this function buffers the scaled version
+  depending on \ref setBackgroundScaled and \ref setBackgroundScaledMode and then draws it inside
+  the viewport with the provided \a painter. The scaled version is buffered in
+  mScaledBackgroundPixmap to prevent expensive rescaling at every redraw. It is only updated, when
+  the axis rect has changed in a way that requires a rescale of the background pixmap (this is
+  dependent on the \ref setBackgroundScaledMode), or when a differend axis background pixmap was
+  set.
+  
+  Note that this function does not draw a fill with the background brush (\ref setBackground(const
+  QBrush &brush)) beneath the pixmap.
+  
+  \see setBackground, setBackgroundScaled, setBackgroundScaledMode
+*/
+void QCustomPlot::drawBackground(QCPPainter *painter)
+{
+  // Note: background color is handled in individual replot/save functions
+
+  // draw background pixmap (on top of fill, if brush specified):
+  if (!mBackgroundPixmap.isNull())
+  {
+    if (mBackgroundScaled)
+    {
+      // check whether mScaledBackground needs to be updated:
+      QSize scaledSize(mBackgroundPixmap.size());
+      scaledSize.scale(mViewport.size(), mBackgroundScaledMode);
+      if (mScaledBackgroundPixmap.size() != scaledSize)
+        mScaledBackgroundPixmap = mBackgroundPixmap.scaled(mViewport.size(), mBackgroundScaledMode, Qt::SmoothTransformation);
+      painter->drawPixmap(mViewport.topLeft(), mScaledBackgroundPixmap, QRect(0, 0, mViewport.width(), mViewport.height()) & mScaledBackgroundPixmap.rect());
+    } else
+    {
+      painter->drawPixmap(mViewport.topLeft(), mBackgroundPixmap, QRect(0, 0, mViewport.width(), mViewport.height()));
+    }
+  }
+}
+
+
+/*! \internal
+  
+  This method is used by \ref QCPAxisRect::removeAxis to report removed axes to the QCustomPlot
+  so it may clear its QCustomPlot::xAxis, yAxis, xAxis2 and yAxis2 members accordingly.
+*/
+void QCustomPlot::axisRemoved(QCPAxis *axis)
+{
+  if (xAxis == axis)
+    xAxis = 0;
+  if (xAxis2 == axis)
+    xAxis2 = 0;
+  if (yAxis == axis)
+    yAxis = 0;
+  if (yAxis2 == axis)
+    yAxis2 = 0;
+  
+  // Note: No need to take care of range drag axes and range zoom axes, because they are stored in smart pointers
+}
+
+/*! \internal
+  
+  This method is used by the QCPLegend destructor to report legend removal to the QCustomPlot so
+  it may clear its QCustomPlot::legend member accordingly.
+*/
+void QCustomPlot::legendRemoved(QCPLegend *legend)
+{
+  if (this->legend == legend)
+    this->legend = 0;
+}
+
+/*! \internal
+  
+  Assigns all layers their index (QCPLayer::mIndex) in the mLayers list. This method is thus called
+  after every operation that changes the layer indices, like layer removal, layer creation, layer
+  moving.
+*/
+void QCustomPlot::updateLayerIndices() const
 {
   for (int i=0; i<mLayers.size(); ++i)
     mLayers.at(i)->mIndex = i;
@@ -11306,53 +12013,44 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
   if (mColorBufferInvalidated)
     updateColorBuffer();
   
-  if (!logarithmic)
-  {
-    const double posToIndexFactor = (mLevelCount-1)/range.size();
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
-      }
+  // the color buffer is the lookup table, values are first mapped to fractional table positions in
+  // chunks, so the clamping and conversion loop below can be vectorized by the compiler:
+  const QRgb *colors = mColorBuffer.constData();
+  const double maxIndex = mLevelCount-1;
+  const double posToIndexFactor = logarithmic ? maxIndex/qLn(range.upper/range.lower) : maxIndex/range.size();
+  const int chunkSize = 256;
+  double positions[chunkSize];
+  int indices[chunkSize];
+  for (int chunkStart=0; chunkStart<n; chunkStart+=chunkSize)
+  {
+    const int chunkCount = qMin(chunkSize, n-chunkStart);
+    const double *chunkData = data+dataIndexFactor*chunkStart;
+    if (!logarithmic)
+    {
+      for (int i=0; i<chunkCount; ++i)
+        positions[i] = (chunkData[dataIndexFactor*i]-range.lower)*posToIndexFactor;
     } else
     {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
+      for (int i=0; i<chunkCount; ++i)
+        positions[i] = qLn(chunkData[dataIndexFactor*i]/range.lower)*posToIndexFactor;
     }
-  } else // logarithmic == true
-  {
     if (mPeriodic)
     {
-      for (int i=0; i<n; ++i)
+      for (int i=0; i<chunkCount; ++i)
       {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1)) % mLevelCount;
+        int index = (int)positions[i] % mLevelCount;
         if (index < 0)
           index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
+        indices[i] = index;
       }
     } else
     {
-      for (int i=0; i<n; ++i)
-      {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
+      for (int i=0; i<chunkCount; ++i)
+        indices[i] = (int)qMin(maxIndex, qMax(0.0, positions[i])); // NaN maps to the lowest color
     }
+    QRgb *chunkScanLine = scanLine+chunkStart;
+    for (int i=0; i<chunkCount; ++i)
+      chunkScanLine[i] = colors[indices[i]];
   }
 }
 
@@ -14369,6 +15067,21 @@ void QCPColorScaleAxisRectPrivate::axisSelectableChanged(QCPAxis::SelectablePart
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*!
+  Returns a new data revision for \ref QCPDataContainer. Revisions are unique within the process
+  and never zero, so zero can be used to mark values that were never derived from any data.
+*/
+quint64 QCP::nextDataRevision()
+{
+  static std::atomic<quint64> revision(0);
+  return ++revision;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPData
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -14542,6 +15255,7 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14566,6 +15280,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14593,6 +15308,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14619,6 +15335,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyError.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14646,6 +15363,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
   n = qMin(n, value.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14673,6 +15391,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
   n = qMin(n, keyError.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14704,6 +15423,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
   n = qMin(n, valueErrorPlus.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -14861,7 +15581,9 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
+  quint64 previousRevision = mData->revision();
   mData->unite(dataMap);
+  extendCachedRanges(previousRevision, dataMap.constBegin(), dataMap.constEnd());
 }
 
 /*! \overload
@@ -14874,7 +15596,9 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
-  mData->insertMulti(data.key, data);
+  quint64 previousRevision = mData->revision();
+  QCPDataMap::const_iterator it = mData->insertMulti(data.key, data);
+  extendCachedRanges(previousRevision, it, it+1);
 }
 
 /*! \overload
@@ -14890,7 +15614,7 @@ void QCPGraph::addData(double key, double value)
   QCPData newData;
   newData.key = key;
   newData.value = value;
-  mData->insertMulti(newData.key, newData);
+  addData(newData);
 }
 
 /*! \overload
@@ -14904,13 +15628,16 @@ void QCPGraph::addData(double key, double value)
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
   int n = qMin(keys.size(), values.size());
+  QCPDataMap newDataMap;
+  newDataMap.reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
     newData.key = keys[i];
     newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
+    newDataMap.insertMulti(newData.key, newData);
   }
+  addData(newDataMap);
 }
 
 /*!
@@ -14919,9 +15646,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -14931,9 +15656,7 @@ void QCPGraph::removeDataBefore(double key)
 void QCPGraph::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -14946,10 +15669,7 @@ void QCPGraph::removeDataAfter(double key)
 void QCPGraph::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -15227,7 +15947,16 @@ void QCPGraph::getLinePlotData(QVector<QPointF> *linePixelData, QVector<QCPData>
   linePixelData->resize(lineData.size());
   
   // transform lineData points to pixels:
-  if (keyAxis->orientation() == Qt::Vertical)
+  QCPLinearTransform keyTransform, valueTransform;
+  if (!lineData.isEmpty() && sizeof(QPointF) == 2*sizeof(double) && keyAxis->getLinearTransform(keyTransform) && valueAxis->getLinearTransform(valueTransform))
+  {
+    // QCPData starts with key and value, so both are transformed in a single vectorized pass:
+    double *pixels = reinterpret_cast<double*>(linePixelData->data());
+    if (keyAxis->orientation() == Qt::Vertical)
+      QCPKernels::linearTransformPairs(&lineData.constData()->key, sizeof(QCPData)/sizeof(double), pixels, lineData.size(), valueTransform, keyTransform, true);
+    else
+      QCPKernels::linearTransformPairs(&lineData.constData()->key, sizeof(QCPData)/sizeof(double), pixels, lineData.size(), keyTransform, valueTransform, false);
+  } else if (keyAxis->orientation() == Qt::Vertical)
   {
     for (int i=0; i<lineData.size(); ++i)
     {
@@ -15535,17 +16264,20 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *scatterDat
   // draw scatter point symbols:
   applyScattersAntialiasingHint(painter);
   mScatterStyle.applyTo(painter, mPen);
+  QVector<QPointF> scatterPositions;
+  scatterPositions.reserve(scatterData->size());
   if (keyAxis->orientation() == Qt::Vertical)
   {
     for (int i=0; i<scatterData->size(); ++i)
       if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key));
+        scatterPositions.append(QPointF(valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key)));
   } else
   {
     for (int i=0; i<scatterData->size(); ++i)
       if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value));
+        scatterPositions.append(QPointF(keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value)));
   }
+  mScatterStyle.drawShapes(painter, scatterPositions);
 }
 
 /*!  \internal
@@ -15646,6 +16378,15 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
   }
 }
 
+/*! \internal
+  
+  Comparison used to find data points by key with the standard binary search algorithms.
+*/
+static bool dataKeyLessThan(const QCPData &data, double key)
+{
+  return data.key < key;
+}
+
 /*! \internal
   
   Returns the \a lineData and \a scatterData that need to be plotted for this graph taking into
@@ -15684,58 +16425,48 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
     {
       QCPDataMap::const_iterator it = lower;
       QCPDataMap::const_iterator upperEnd = upper+1;
-      double minValue = it.value().value;
-      double maxValue = it.value().value;
-      QCPDataMap::const_iterator currentIntervalFirstPoint = it;
       int reversedFactor = keyAxis->rangeReversed() != (keyAxis->orientation()==Qt::Vertical) ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() != (keyAxis->orientation()==Qt::Vertical) ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
       double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
       double lastIntervalEndKey = currentIntervalStartKey;
       double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-      int intervalDataCount = 1;
-      ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
       while (it != upperEnd)
       {
-        if (it.key() < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
+        // keys are sorted, so the end of the pixel interval is found with a galloping search:
+        double intervalEndKey = currentIntervalStartKey+keyEpsilon;
+        QCPDataMap::const_iterator searchBegin = it+1;
+        QCPDataMap::const_iterator searchEnd = it+1;
+        int step = 1;
+        while (searchEnd != upperEnd && searchEnd.key() < intervalEndKey)
         {
-          if (it.value().value < minValue)
-            minValue = it.value().value;
-          else if (it.value().value > maxValue)
-            maxValue = it.value().value;
-          ++intervalDataCount;
-        } else // new pixel interval started
+          searchBegin = searchEnd+1;
+          searchEnd = upperEnd-searchBegin > step ? searchBegin+step : upperEnd;
+          step *= 2;
+        }
+        QCPDataMap::const_iterator intervalEnd = std::lower_bound(searchBegin, searchEnd, intervalEndKey, dataKeyLessThan);
+        int intervalDataCount = intervalEnd-it;
+        if (intervalDataCount >= 2) // pixel has multiple data points, consolidate them to a cluster
+        {
+          double minValue, maxValue;
+          QCPKernels::minMax(&it->value, sizeof(QCPData)/sizeof(double), intervalDataCount, minValue, maxValue);
+          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, it.value().value));
+          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+          if (intervalEnd != upperEnd && intervalEnd.key() > currentIntervalStartKey+keyEpsilon*2) // next pixel starts further away from this cluster, so make sure the last point of the cluster is at a real data point
+            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.8, (intervalEnd-1).value().value));
+        } else
+          lineData->append(QCPData(it.key(), it.value().value));
+        lastIntervalEndKey = (intervalEnd-1).value().key;
+        it = intervalEnd;
+        if (it != upperEnd)
         {
-          if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-          {
-            if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-              lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint.value().value));
-            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-            lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-            if (it.key() > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-              lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.8, (it-1).value().value));
-          } else
-            lineData->append(QCPData(currentIntervalFirstPoint.key(), currentIntervalFirstPoint.value().value));
-          lastIntervalEndKey = (it-1).value().key;
-          minValue = it.value().value;
-          maxValue = it.value().value;
-          currentIntervalFirstPoint = it;
           currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
           if (keyEpsilonVariable)
             keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-          intervalDataCount = 1;
         }
-        ++it;
       }
-      // handle last interval:
-      if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-      {
-        if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-          lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint.value().value));
-        lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-        lineData->append(QCPData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-      } else
-        lineData->append(QCPData(currentIntervalFirstPoint.key(), currentIntervalFirstPoint.value().value));
     }
     
     if (scatterData)
@@ -16504,6 +17235,40 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain) cons
   \see getKeyRange(bool &foundRange, SignDomain inSignDomain)
 */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
+{
+  CachedRange &cached = mKeyRangeCache[cachedRangeIndex(inSignDomain, includeErrors)];
+  if (cached.revision != mData->revision())
+  {
+    cached.range = calcKeyRange(mData->constBegin(), mData->constEnd(), cached.foundRange, inSignDomain, includeErrors);
+    cached.revision = mData->revision();
+  }
+  foundRange = cached.foundRange;
+  return cached.range;
+}
+
+/*! \overload
+  
+  Allows to specify whether the error bars should be included in the range calculation.
+  
+  \see getValueRange(bool &foundRange, SignDomain inSignDomain)
+*/
+QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
+{
+  CachedRange &cached = mValueRangeCache[cachedRangeIndex(inSignDomain, includeErrors)];
+  if (cached.revision != mData->revision())
+  {
+    cached.range = calcValueRange(mData->constBegin(), mData->constEnd(), cached.foundRange, inSignDomain, includeErrors);
+    cached.revision = mData->revision();
+  }
+  foundRange = cached.foundRange;
+  return cached.range;
+}
+
+/*! \internal
+  
+  Calculates the key range of the data points in [\a begin, \a end), see \ref getKeyRange.
+*/
+QCPRange QCPGraph::calcKeyRange(QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -16513,8 +17278,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       if (!qIsNaN(it.value().value))
       {
@@ -16536,8 +17301,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       if (!qIsNaN(it.value().value))
       {
@@ -16572,8 +17337,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       if (!qIsNaN(it.value().value))
       {
@@ -16612,13 +17377,11 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   return range;
 }
 
-/*! \overload
-  
-  Allows to specify whether the error bars should be included in the range calculation.
+/*! \internal
   
-  \see getValueRange(bool &foundRange, SignDomain inSignDomain)
+  Calculates the value range of the data points in [\a begin, \a end), see \ref getValueRange.
 */
-QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
+QCPRange QCPGraph::calcValueRange(QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -16628,8 +17391,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -16651,8 +17414,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -16687,8 +17450,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    QCPDataMap::const_iterator it = begin;
+    while (it != end)
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -16727,41 +17490,510 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
   return range;
 }
 
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPCurveData
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPCurveData
-  \brief Holds the data of one single data point for QCPCurve.
-  
-  The container for storing multiple data points is \ref QCPCurveDataMap.
-  
-  The stored data is:
-  \li \a t: the free parameter of the curve at this curve point (cp. the mathematical vector <em>(x(t), y(t))</em>)
-  \li \a key: coordinate on the key axis of this curve point
-  \li \a value: coordinate on the value axis of this curve point
+/*! \internal
   
-  \see QCPCurveDataMap
+  Returns the index of the cached key and value ranges for \a inSignDomain and \a includeErrors.
 */
-
-/*!
-  Constructs a curve data point with t, key and value set to zero.
-*/
-QCPCurveData::QCPCurveData() :
-  t(0),
-  key(0),
-  value(0)
+int QCPGraph::cachedRangeIndex(SignDomain inSignDomain, bool includeErrors)
 {
+  return int(inSignDomain)*2+(includeErrors ? 1 : 0);
 }
 
-/*!
-  Constructs a curve data point with the specified \a t, \a key and \a value.
+/*! \internal
+  
+  Called after the data points in [\a begin, \a end) were added to the data. The cached ranges
+  that were valid for \a previousRevision are extended by these points, so adding data doesn't
+  require a pass over all data points during the next rescale. Other cached ranges stay invalid and
+  are recalculated when needed.
 */
-QCPCurveData::QCPCurveData(double t, double key, double value) :
-  t(t),
-  key(key),
-  value(value)
+void QCPGraph::extendCachedRanges(quint64 previousRevision, QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end) const
+{
+  for (int i=0; i<6; ++i)
+  {
+    SignDomain inSignDomain = SignDomain(i/2);
+    bool includeErrors = i%2 == 1;
+    if (mKeyRangeCache[i].revision == previousRevision)
+    {
+      bool found;
+      QCPRange range = calcKeyRange(begin, end, found, inSignDomain, includeErrors);
+      mergeCachedRange(mKeyRangeCache[i], range, found);
+    }
+    if (mValueRangeCache[i].revision == previousRevision)
+    {
+      bool found;
+      QCPRange range = calcValueRange(begin, end, found, inSignDomain, includeErrors);
+      mergeCachedRange(mValueRangeCache[i], range, found);
+    }
+  }
+}
+
+/*! \internal
+  
+  Extends \a cached by \a range, if \a found, and marks it valid for the current data revision.
+*/
+void QCPGraph::mergeCachedRange(CachedRange &cached, const QCPRange &range, bool found) const
+{
+  if (found)
+  {
+    if (!cached.foundRange)
+      cached.range = range;
+    else
+    {
+      cached.range.lower = qMin(cached.range.lower, range.lower);
+      cached.range.upper = qMax(cached.range.upper, range.upper);
+    }
+    cached.foundRange = true;
+  }
+  cached.revision = mData->revision();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCompactData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCompactData
+  \brief Holds the data of one single data point for QCPCompactGraph.
+  
+  The container for storing multiple data points is \ref QCPCompactDataMap.
+  
+  The stored data is:
+  \li \a key: coordinate on the key axis of this data point
+  \li \a value: coordinate on the value axis of this data point
+  
+  Both are stored in single precision, so a data point takes 8 bytes instead of the 48 bytes of a
+  \ref QCPData.
+  
+  \see QCPCompactDataMap
+*/
+
+/*!
+  Constructs a data point with key and value set to zero.
+*/
+QCPCompactData::QCPCompactData() :
+  key(0),
+  value(0)
+{
+}
+
+/*!
+  Constructs a data point with the specified \a key and \a value, rounded to single precision.
+*/
+QCPCompactData::QCPCompactData(double key, double value) :
+  key(float(key)),
+  value(float(value))
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCompactGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCompactGraph
+  \brief A plottable for long series of key/value pairs, stored in single precision
+  
+  QCPCompactGraph draws its data as a line, like a \ref QCPGraph with line style \ref
+  QCPGraph::lsLine. It has no error bars, fills or other line styles, and in exchange holds its data
+  in a \ref QCPCompactDataMap, which takes 8 bytes per data point. Use it for long recordings of
+  float data, where the data of a QCPGraph would be several times larger than its source.
+  
+  If there are more data points than pixels in the visible key range, each pixel column is drawn
+  from the first, smallest, largest and last value in it, so narrow peaks stay visible. Scatter
+  symbols are only drawn if there are fewer data points than pixels. Points with NaN values
+  interrupt the line.
+  
+  Like all data representing objects in QCustomPlot, the QCPCompactGraph is a plottable. Create it
+  with a key and value axis of the same axis rect and add it with \ref QCustomPlot::addPlottable.
+*/
+
+/*!
+  Constructs a compact graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its
+  value axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not
+  have the same orientation. If either of these restrictions is violated, a corresponding message
+  is printed to the debug output (qDebug), the construction is not aborted, though.
+  
+  The constructed QCPCompactGraph can be added to the plot with QCustomPlot::addPlottable,
+  QCustomPlot then takes ownership of the graph.
+*/
+QCPCompactGraph::QCPCompactGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis)
+{
+  mData = new QCPCompactDataMap;
+  
+  setPen(QPen(Qt::blue, 0));
+  setBrush(Qt::NoBrush);
+  setSelectedPen(QPen(QColor(80, 80, 255), 2.5));
+  setSelectedBrush(Qt::NoBrush);
+}
+
+QCPCompactGraph::~QCPCompactGraph()
+{
+  delete mData;
+}
+
+/*!
+  Replaces the current data with the provided \a data. Since the container is implicitly shared,
+  this doesn't copy any data points until one of the containers is modified.
+*/
+void QCPCompactGraph::setData(const QCPCompactDataMap &data)
+{
+  *mData = data;
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a key and \a value pairs. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+*/
+void QCPCompactGraph::setData(const QVector<double> &key, const QVector<double> &value)
+{
+  mData->clear();
+  addData(key, value);
+}
+
+/*!
+  Sets the visual appearance of single data points in the plot. If set to \ref
+  QCPScatterStyle::ssNone, no scatter points are drawn (e.g. for line-only-plots with appropriate
+  line style).
+  
+  \see QCPScatterStyle
+*/
+void QCPCompactGraph::setScatterStyle(const QCPScatterStyle &style)
+{
+  mScatterStyle = style;
+}
+
+/*!
+  Adds the provided single data point as \a key and \a value pair to the current data.
+*/
+void QCPCompactGraph::addData(double key, double value)
+{
+  QCPCompactData newData(key, value);
+  mData->insertMulti(newData.key, newData);
+}
+
+/*! \overload
+  
+  Adds the provided data points as \a key and \a value pairs to the current data.
+*/
+void QCPCompactGraph::addData(const QVector<double> &keys, const QVector<double> &values)
+{
+  int n = qMin(keys.size(), values.size());
+  mData->reserve(mData->size()+n);
+  for (int i=0; i<n; ++i)
+  {
+    QCPCompactData newData(keys[i], values[i]);
+    mData->insertMulti(newData.key, newData);
+  }
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPCompactGraph::removeDataBefore(double key)
+{
+  mData->erase(mData->begin(), mData->lowerBound(key));
+}
+
+/*!
+  Removes all data points with keys greater than \a key.
+*/
+void QCPCompactGraph::removeDataAfter(double key)
+{
+  mData->erase(mData->upperBound(key), mData->end());
+}
+
+/*!
+  Removes all data points.
+*/
+void QCPCompactGraph::clearData()
+{
+  mData->clear();
+}
+
+/* inherits documentation from base class */
+double QCPCompactGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  Q_UNUSED(details)
+  if ((onlySelectable && !mSelectable) || mData->isEmpty())
+    return -1;
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
+  if (!mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+    return -1;
+  
+  QVector<QPointF> lineData;
+  getLinePlotData(&lineData);
+  double minDistSqr = std::numeric_limits<double>::max();
+  for (int i=0; i<lineData.size(); ++i)
+  {
+    if (qIsNaN(lineData.at(i).x()))
+      continue;
+    double distSqr;
+    if (i+1 < lineData.size() && !qIsNaN(lineData.at(i+1).x()))
+      distSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pos);
+    else
+      distSqr = QVector2D(lineData.at(i)-pos).lengthSquared();
+    if (distSqr < minDistSqr)
+      minDistSqr = distSqr;
+  }
+  return minDistSqr < std::numeric_limits<double>::max() ? qSqrt(minDistSqr) : -1;
+}
+
+/* inherits documentation from base class */
+void QCPCompactGraph::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mKeyAxis.data()->range().size() <= 0 || mData->isEmpty()) return;
+  
+  QVector<QPointF> lineData;
+  bool decimated = getLinePlotData(&lineData);
+  
+  // draw line, interrupted at NaN points:
+  if (mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mainPen());
+    painter->setBrush(Qt::NoBrush);
+    int segmentStart = 0;
+    for (int i=0; i<=lineData.size(); ++i)
+    {
+      if (i == lineData.size() || qIsNaN(lineData.at(i).x()))
+      {
+        if (i-segmentStart > 1)
+          painter->drawPolyline(lineData.constData()+segmentStart, i-segmentStart);
+        segmentStart = i+1;
+      }
+    }
+  }
+  
+  // draw scatters, if the points aren't too dense:
+  if (!mScatterStyle.isNone() && !decimated)
+  {
+    applyScattersAntialiasingHint(painter);
+    mScatterStyle.applyTo(painter, mPen);
+    mScatterStyle.drawShapes(painter, lineData);
+  }
+}
+
+/* inherits documentation from base class */
+void QCPCompactGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  // draw line vertically centered:
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(mPen);
+  painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
+  // draw scatter symbol:
+  if (!mScatterStyle.isNone())
+  {
+    applyScattersAntialiasingHint(painter);
+    mScatterStyle.applyTo(painter, mPen);
+    mScatterStyle.drawShape(painter, QRectF(rect).center());
+  }
+}
+
+/* inherits documentation from base class */
+QCPRange QCPCompactGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  CachedRange &cached = mKeyRangeCache[inSignDomain];
+  if (cached.revision != mData->revision())
+  {
+    cached.range = calcRange(true, cached.foundRange, inSignDomain);
+    cached.revision = mData->revision();
+  }
+  foundRange = cached.foundRange;
+  return cached.range;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPCompactGraph::getValueRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  CachedRange &cached = mValueRangeCache[inSignDomain];
+  if (cached.revision != mData->revision())
+  {
+    cached.range = calcRange(false, cached.foundRange, inSignDomain);
+    cached.revision = mData->revision();
+  }
+  foundRange = cached.foundRange;
+  return cached.range;
+}
+
+/*! \internal
+  
+  Transforms the visible data points to pixel coordinates and places them in \a linePixelData.
+  Points with NaN values are passed as points with NaN coordinates, which mark interruptions of
+  the line.
+  
+  If there are more points than pixels along the key axis, the points are decimated per pixel
+  column to the first, smallest, largest and last value in that column. Returns whether the points
+  were decimated.
+*/
+bool QCPCompactGraph::getLinePlotData(QVector<QPointF> *linePixelData) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return false; }
+  
+  QCPCompactDataMap::const_iterator begin, end;
+  getVisibleDataBounds(begin, end);
+  int count = end-begin;
+  if (count <= 0)
+    return false;
+  
+  const bool vertical = keyAxis->orientation() == Qt::Vertical;
+  const QPointF nanPoint(qQNaN(), qQNaN());
+  int keyPixelSpan = vertical ? keyAxis->axisRect()->height() : keyAxis->axisRect()->width();
+  if (count <= 2*keyPixelSpan)
+  {
+    linePixelData->reserve(count);
+    for (QCPCompactDataMap::const_iterator it = begin; it != end; ++it)
+    {
+      if (qIsNaN(it->value))
+        linePixelData->append(nanPoint);
+      else
+      {
+        double k = keyAxis->coordToPixel(it->key), v = valueAxis->coordToPixel(it->value);
+        linePixelData->append(vertical ? QPointF(v, k) : QPointF(k, v));
+      }
+    }
+    return false;
+  }
+  
+  // more points than pixels, reduce each pixel column to at most four points:
+  QCPLinearTransform keyTransform;
+  const bool linear = keyAxis->getLinearTransform(keyTransform);
+  linePixelData->reserve(4*keyPixelSpan+4);
+  QCPCompactDataMap::const_iterator columnFirst = end;
+  QCPCompactDataMap::const_iterator columnLast, columnMin, columnMax;
+  double columnPixel = 0, firstPixel = 0, lastPixel = 0;
+  for (QCPCompactDataMap::const_iterator it = begin; it <= end; ++it)
+  {
+    double keyPixel = 0;
+    bool nan = it != end && qIsNaN(it->value);
+    if (it != end && !nan)
+      keyPixel = linear ? (it->key-keyTransform.origin)*keyTransform.scale+keyTransform.offset : keyAxis->coordToPixel(it->key);
+    // close the current column at the end, at NaN points and when the pixel column changes:
+    if (columnFirst != end && (it == end || nan || std::floor(keyPixel) != columnPixel))
+    {
+      double columnCenter = columnPixel+0.5;
+      QCPCompactDataMap::const_iterator columnPoints[4] = { columnFirst, columnMin < columnMax ? columnMin : columnMax, columnMin < columnMax ? columnMax : columnMin, columnLast };
+      double columnKeys[4] = { firstPixel, columnCenter, columnCenter, lastPixel };
+      for (int i=0; i<4; ++i)
+      {
+        if (i > 0 && columnPoints[i] == columnPoints[i-1])
+          continue;
+        double v = valueAxis->coordToPixel(columnPoints[i]->value);
+        linePixelData->append(vertical ? QPointF(v, columnKeys[i]) : QPointF(columnKeys[i], v));
+      }
+      columnFirst = end;
+    }
+    if (it == end)
+      break;
+    if (nan)
+    {
+      linePixelData->append(nanPoint);
+      continue;
+    }
+    if (columnFirst == end)
+    {
+      columnFirst = columnLast = columnMin = columnMax = it;
+      columnPixel = std::floor(keyPixel);
+      firstPixel = keyPixel;
+    } else
+    {
+      if (it->value < columnMin->value)
+        columnMin = it;
+      if (it->value > columnMax->value)
+        columnMax = it;
+    }
+    columnLast = it;
+    lastPixel = keyPixel;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Sets \a begin and \a end to the range of data points that need to be drawn for the visible key
+  range. This includes one point outside the range on each side, so the line continues to the
+  border of the axis rect.
+*/
+void QCPCompactGraph::getVisibleDataBounds(QCPCompactDataMap::const_iterator &begin, QCPCompactDataMap::const_iterator &end) const
+{
+  const QCPCompactDataMap &data = *mData;
+  begin = data.lowerBound(mKeyAxis.data()->range().lower);
+  if (begin != data.constBegin())
+    --begin;
+  end = data.upperBound(mKeyAxis.data()->range().upper);
+  if (end != data.constEnd())
+    ++end;
+}
+
+/*! \internal
+  
+  Calculates the key range (if \a keyRange is true) or value range of all data points in \a
+  inSignDomain. Points with NaN values are skipped. Called by \ref getKeyRange and \ref
+  getValueRange if the data changed since the last call.
+*/
+QCPRange QCPCompactGraph::calcRange(bool keyRange, bool &foundRange, SignDomain inSignDomain) const
+{
+  QCPRange range;
+  foundRange = false;
+  for (QCPCompactDataMap::const_iterator it = mData->constBegin(); it != mData->constEnd(); ++it)
+  {
+    if (qIsNaN(it->value))
+      continue;
+    double current = keyRange ? it->key : it->value;
+    if ((inSignDomain == sdNegative && current >= 0) || (inSignDomain == sdPositive && current <= 0))
+      continue;
+    if (!foundRange)
+    {
+      range.lower = range.upper = current;
+      foundRange = true;
+    } else if (current < range.lower)
+      range.lower = current;
+    else if (current > range.upper)
+      range.upper = current;
+  }
+  return range;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveData
+  \brief Holds the data of one single data point for QCPCurve.
+  
+  The container for storing multiple data points is \ref QCPCurveDataMap.
+  
+  The stored data is:
+  \li \a t: the free parameter of the curve at this curve point (cp. the mathematical vector <em>(x(t), y(t))</em>)
+  \li \a key: coordinate on the key axis of this curve point
+  \li \a value: coordinate on the value axis of this curve point
+  
+  \see QCPCurveDataMap
+*/
+
+/*!
+  Constructs a curve data point with t, key and value set to zero.
+*/
+QCPCurveData::QCPCurveData() :
+  t(0),
+  key(0),
+  value(0)
+{
+}
+
+/*!
+  Constructs a curve data point with the specified \a t, \a key and \a value.
+*/
+QCPCurveData::QCPCurveData(double t, double key, double value) :
+  t(t),
+  key(key),
+  value(value)
 {
 }
 
@@ -16810,7 +18042,9 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   then takes ownership of the graph.
 */
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable(keyAxis, valueAxis)
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mKeysAscendingRevision(0),
+  mKeysAscending(false)
 {
   mData = new QCPCurveDataMap;
   mPen.setColor(Qt::blue);
@@ -16867,6 +18101,7 @@ void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, con
   int n = t.size();
   n = qMin(n, key.size());
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPCurveData newData;
   for (int i=0; i<n; ++i)
   {
@@ -16887,6 +18122,7 @@ void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPCurveData newData;
   for (int i=0; i<n; ++i)
   {
@@ -16997,9 +18233,7 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 */
 void QCPCurve::removeDataBefore(double t)
 {
-  QCPCurveDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < t)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(t));
 }
 
 /*!
@@ -17009,9 +18243,7 @@ void QCPCurve::removeDataBefore(double t)
 void QCPCurve::removeDataAfter(double t)
 {
   if (mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(t);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(t), mData->end());
 }
 
 /*!
@@ -17024,10 +18256,7 @@ void QCPCurve::removeDataAfter(double t)
 void QCPCurve::removeData(double fromt, double tot)
 {
   if (fromt >= tot || mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(fromt);
-  QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromt), mData->upperBound(tot));
 }
 
 /*! \overload
@@ -17205,6 +18434,21 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
       mScatterStyle.drawShape(painter,  pointData->at(i));
 }
 
+/*! \internal
+  
+  Comparisons used to find curve points by key with the standard binary search algorithms. Only
+  valid if \ref keysAscending returns true.
+*/
+static bool curveDataKeyLessThan(const QCPCurveData &data, double key)
+{
+  return data.key < key;
+}
+
+static bool keyLessThanCurveData(double key, const QCPCurveData &data)
+{
+  return key < data.key;
+}
+
 /*! \internal
   
   called by QCPCurve::draw to generate a point vector (in pixel coordinates) which represents the
@@ -17232,12 +18476,24 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   double rectRight = keyAxis->pixelToCoord(keyAxis->coordToPixel(keyAxis->range().upper)+strokeMargin*((keyAxis->orientation()==Qt::Vertical)!=keyAxis->rangeReversed()?-1:1));
   double rectBottom = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().lower)+strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
   double rectTop = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().upper)-strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
+  // if the keys increase along the curve, segments outside of the visible key range can't reach into R, so only
+  // the points inside plus the ones just before and after are processed. Not done with a fill, because the fill
+  // polygon is closed between the last and first point:
+  QCPCurveDataMap::const_iterator begin = mData->constBegin();
+  QCPCurveDataMap::const_iterator end = mData->constEnd();
+  if ((mainBrush().style() == Qt::NoBrush || mainBrush().color().alpha() == 0) && keysAscending())
+  {
+    begin = std::lower_bound(mData->constBegin(), mData->constEnd(), rectLeft, curveDataKeyLessThan);
+    end = std::upper_bound(begin, mData->constEnd(), rectRight, keyLessThanCurveData);
+    if (end != mData->constEnd())
+      ++end;
+  }
   int currentRegion;
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  QCPCurveDataMap::const_iterator prevIt = mData->constEnd()-1;
+  QCPCurveDataMap::const_iterator it = begin;
+  QCPCurveDataMap::const_iterator prevIt = begin != mData->constBegin() ? begin-1 : mData->constEnd()-1;
   int prevRegion = getRegion(prevIt.value().key, prevIt.value().value, rectLeft, rectTop, rectRight, rectBottom);
   QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
-  while (it != mData->constEnd())
+  while (it != end)
   {
     currentRegion = getRegion(it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
     if (currentRegion != prevRegion) // changed region, possibly need to add some optimized edge points or original points if entering R
@@ -17297,6 +18553,31 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   *lineData << trailingPoints;
 }
 
+/*! \internal
+  
+  Returns whether the keys of the curve points don't decrease with the curve parameter t, i.e. the
+  curve never moves back in key direction. The result is cached until the data is modified.
+*/
+bool QCPCurve::keysAscending() const
+{
+  if (mKeysAscendingRevision != mData->revision())
+  {
+    mKeysAscending = true;
+    QCPCurveDataMap::const_iterator it = mData->constBegin();
+    for (double prevKey = -std::numeric_limits<double>::max(); it != mData->constEnd(); ++it)
+    {
+      if (!(it.value().key >= prevKey)) // also catches NaN keys
+      {
+        mKeysAscending = false;
+        break;
+      }
+      prevKey = it.value().key;
+    }
+    mKeysAscendingRevision = mData->revision();
+  }
+  return mKeysAscending;
+}
+
 /*! \internal
   
   This function is part of the curve optimization algorithm of \ref getCurveData.
@@ -18573,6 +19854,7 @@ void QCPBars::setData(const QVector<double> &key, const QVector<double> &value)
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPBarData newData;
   for (int i=0; i<n; ++i)
   {
@@ -18701,9 +19983,7 @@ void QCPBars::addData(const QVector<double> &keys, const QVector<double> &values
 */
 void QCPBars::removeDataBefore(double key)
 {
-  QCPBarDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -18713,9 +19993,7 @@ void QCPBars::removeDataBefore(double key)
 void QCPBars::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPBarDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -18728,10 +20006,7 @@ void QCPBars::removeDataAfter(double key)
 void QCPBars::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPBarDataMap::iterator it = mData->upperBound(fromKey);
-  QCPBarDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -19623,6 +20898,12 @@ QCPRange QCPStatisticalBox::getValueRange(bool &foundRange, SignDomain inSignDom
 
 /* end of documentation of inline functions */
 
+/*! \internal
+  
+  Edge length in cells of the square tiles, in which modifications of the data are tracked.
+*/
+static const int colorMapTileSize = 128;
+
 /*!
   Constructs a new QCPColorMapData instance. The instance has \a keySize cells in the key direction
   and \a valueSize cells in the value direction. These cells will be displayed by the \ref QCPColorMap
@@ -19676,7 +20957,7 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
     if (!mIsEmpty)
       memcpy(mData, other.mData, sizeof(mData[0])*keySize*valueSize);
     mDataBounds = other.mDataBounds;
-    mDataModified = true;
+    setAllModified();
   }
   return *this;
 }
@@ -19737,7 +21018,7 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
         qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
     } else
       mData = 0;
-    mDataModified = true;
+    setAllModified();
   }
 }
 
@@ -19840,7 +21121,7 @@ void QCPColorMapData::setData(double key, double value, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    setCellModified(keyCell, valueCell);
   }
 }
 
@@ -19864,7 +21145,7 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    setCellModified(keyIndex, valueIndex);
   }
 }
 
@@ -19919,7 +21200,7 @@ void QCPColorMapData::fill(double z)
   for (int i=0; i<dataCount; ++i)
     mData[i] = z;
   mDataBounds = QCPRange(z, z);
-  mDataModified = true;
+  setAllModified();
 }
 
 /*!
@@ -19970,6 +21251,46 @@ void QCPColorMapData::cellToCoord(int keyIndex, int valueIndex, double *key, dou
     *value = valueIndex/(double)(mValueSize-1)*(mValueRange.upper-mValueRange.lower)+mValueRange.lower;
 }
 
+/*! \internal
+  
+  Returns the number of tiles in the key dimension. Modifications are tracked per square tile of
+  colorMapTileSize cells, so QCPColorMap only needs to colorize the tiles that contain modified
+  cells.
+*/
+int QCPColorMapData::keyTileCount() const
+{
+  return (mKeySize+colorMapTileSize-1)/colorMapTileSize;
+}
+
+/*! \internal
+  
+  Returns the number of tiles in the value dimension, see \ref keyTileCount.
+*/
+int QCPColorMapData::valueTileCount() const
+{
+  return (mValueSize+colorMapTileSize-1)/colorMapTileSize;
+}
+
+/*! \internal
+  
+  Marks the tile that contains the cell with indices \a keyIndex and \a valueIndex as modified.
+*/
+void QCPColorMapData::setCellModified(int keyIndex, int valueIndex)
+{
+  mModifiedTiles.setBit(valueIndex/colorMapTileSize*keyTileCount() + keyIndex/colorMapTileSize);
+  mDataModified = true;
+}
+
+/*! \internal
+  
+  Marks all tiles as modified, e.g. after the size changed or all cells were overwritten.
+*/
+void QCPColorMapData::setAllModified()
+{
+  mModifiedTiles.fill(true, keyTileCount()*valueTileCount());
+  mDataModified = true;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMap
@@ -20082,7 +21403,8 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mMapData(new QCPColorMapData(10, 10, QCPRange(0, 5), QCPRange(0, 5))),
   mInterpolate(true),
   mTightBoundary(false),
-  mMapImageInvalidated(true)
+  mMapImageInvalidated(true),
+  mMapImageKeyOrientation(Qt::Horizontal)
 {
 }
 
@@ -20332,7 +21654,8 @@ double QCPColorMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant
   
   This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
   has been invalidated for a different reason (e.g. a change of the data range with \ref
-  setDataRange).
+  setDataRange). If only some cells were modified, only the tiles of the image that contain them are
+  colorized again (see \ref QCPColorMapData::setCell).
   
   If the map cell count is low, the image created will be oversampled in order to avoid a
   QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
@@ -20351,10 +21674,13 @@ void QCPColorMap::updateMapImage()
   int valueOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)valueSize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
+  bool imageResized = true;
   if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
     mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), QImage::Format_RGB32);
   else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
     mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), QImage::Format_RGB32);
+  else
+    imageResized = false;
   
   QImage *localMapImage = &mMapImage; // this is the image on which the colorization operates. Either the final mMapImage, or if we need oversampling, mUndersampledMapImage
   if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
@@ -20368,24 +21694,40 @@ void QCPColorMap::updateMapImage()
   } else if (!mUndersampledMapImage.isNull())
     mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
   
+  // if only cells changed since the last update, the image is still valid outside of the modified tiles:
+  const bool oversampled = keyOversamplingFactor > 1 || valueOversamplingFactor > 1;
+  const bool onlyModifiedTiles = !mMapImageInvalidated && !imageResized && !oversampled && mMapImageKeyOrientation == keyAxis->orientation();
+  
   const double *rawData = mMapData->mData;
-  if (keyAxis->orientation() == Qt::Horizontal)
+  const bool logarithmic = mDataScaleType==QCPAxis::stLogarithmic;
+  const int keyTiles = mMapData->keyTileCount();
+  const int valueTiles = mMapData->valueTileCount();
+  for (int valueTile=0; valueTile<valueTiles; ++valueTile)
   {
-    const int lineCount = valueSize;
-    const int rowCount = keySize;
-    for (int line=0; line<lineCount; ++line)
+    for (int keyTile=0; keyTile<keyTiles; ++keyTile)
     {
-      QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-    }
-  } else // keyAxis->orientation() == Qt::Vertical
-  {
-    const int lineCount = keySize;
-    const int rowCount = valueSize;
-    for (int line=0; line<lineCount; ++line)
-    {
-      QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+      if (onlyModifiedTiles && !mMapData->mModifiedTiles.testBit(valueTile*keyTiles+keyTile))
+        continue;
+      const int keyStart = keyTile*colorMapTileSize;
+      const int keyEnd = qMin(keyStart+colorMapTileSize, keySize);
+      const int valueStart = valueTile*colorMapTileSize;
+      const int valueEnd = qMin(valueStart+colorMapTileSize, valueSize);
+      // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+      if (keyAxis->orientation() == Qt::Horizontal)
+      {
+        for (int line=valueStart; line<valueEnd; ++line)
+        {
+          QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(valueSize-1-line)) + keyStart;
+          mGradient.colorize(rawData+line*keySize+keyStart, mDataRange, pixels, keyEnd-keyStart, 1, logarithmic);
+        }
+      } else // keyAxis->orientation() == Qt::Vertical
+      {
+        for (int line=keyStart; line<keyEnd; ++line)
+        {
+          QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(keySize-1-line)) + valueStart;
+          mGradient.colorize(rawData+valueStart*keySize+line, mDataRange, pixels, valueEnd-valueStart, keySize, logarithmic);
+        }
+      }
     }
   }
   
@@ -20396,8 +21738,10 @@ void QCPColorMap::updateMapImage()
     else
       mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
   }
+  mMapData->mModifiedTiles.fill(false);
   mMapData->mDataModified = false;
   mMapImageInvalidated = false;
+  mMapImageKeyOrientation = keyAxis->orientation();
 }
 
 /* inherits documentation from base class */
@@ -20457,7 +21801,17 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  if (mirrorX || mirrorY)
+  {
+    // mirror with the painter instead of copying the whole map image on every replot:
+    localPainter->save();
+    localPainter->translate(imageRect.center());
+    localPainter->scale(mirrorX ? -1 : 1, mirrorY ? -1 : 1);
+    localPainter->translate(-imageRect.center());
+    localPainter->drawImage(imageRect, mMapImage);
+    localPainter->restore();
+  } else
+    localPainter->drawImage(imageRect, mMapImage);
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -20700,6 +22054,7 @@ void QCPFinancial::setData(const QVector<double> &key, const QVector<double> &op
   n = qMin(n, high.size());
   n = qMin(n, low.size());
   n = qMin(n, close.size());
+  mData->reserve(n);
   for (int i=0; i<n; ++i)
   {
     mData->insertMulti(key[i], QCPFinancialData(key[i], open[i], high[i], low[i], close[i]));
@@ -20865,9 +22220,7 @@ void QCPFinancial::addData(const QVector<double> &key, const QVector<double> &op
 */
 void QCPFinancial::removeDataBefore(double key)
 {
-  QCPFinancialDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -20878,9 +22231,7 @@ void QCPFinancial::removeDataBefore(double key)
 void QCPFinancial::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPFinancialDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -20893,10 +22244,7 @@ void QCPFinancial::removeDataAfter(double key)
 void QCPFinancial::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPFinancialDataMap::iterator it = mData->upperBound(fromKey);
-  QCPFinancialDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -21428,6 +22776,9 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
   \a upper returns an iterator to the highest data point. Same as before, \a upper may also lie
   just outside of the visible range.
   
+  On a linear key axis, only the items that reach into the visible key range with their width
+  (\ref setWidth) are returned. If there are none, \a upper points to constEnd.
+  
   if the plottable contains no data, both \a lower and \a upper point to constEnd.
   
   \see QCPGraph::getVisibleDataBounds
@@ -21442,6 +22793,16 @@ void QCPFinancial::getVisibleDataBounds(QCPFinancialDataMap::const_iterator &low
     return;
   }
   
+  if (mKeyAxis.data()->scaleType() == QCPAxis::stLinear)
+  {
+    // items extend by half their width to both sides, so exactly the ones that reach into the key range are found:
+    QCPFinancialDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis.data()->range().lower-mWidth*0.5);
+    QCPFinancialDataMap::const_iterator ubound = mData->upperBound(mKeyAxis.data()->range().upper+mWidth*0.5);
+    lower = lbound;
+    upper = lbound != ubound ? ubound-1 : mData->constEnd();
+    return;
+  }
+  
   // get visible data range as QMap iterators
   QCPFinancialDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis.data()->range().lower);
   QCPFinancialDataMap::const_iterator ubound = mData->upperBound(mKeyAxis.data()->range().upper);
@@ -42,9 +42,11 @@
 #include <QVector2D>
 #include <QStack>
 #include <QCache>
+#include <QBitArray>
 #include <QMargins>
 #include <qmath.h>
 #include <limits>
+#include <iterator>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -73,6 +75,7 @@ class QCPAbstractLegendItem;
 class QCPColorMap;
 class QCPColorScale;
 class QCPBars;
+class QThreadPool;
 
 
 /*! \file */
@@ -142,6 +145,8 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint.
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phParallelRendering = 0x008 ///< <tt>0x008</tt> consecutive plottables are rasterized concurrently into separate image buffers on a thread pool, which are then composited.
+                                              ///<                Only applies to raster output. Plottables must not share mutable state without synchronizing it. Plottables with pixmap scatters or textured pens and brushes are drawn serially.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -293,6 +298,7 @@ public:
   void applyTo(QCPPainter *painter, const QPen &defaultPen) const;
   void drawShape(QCPPainter *painter, QPointF pos) const;
   void drawShape(QCPPainter *painter, double x, double y) const;
+  void drawShapes(QCPPainter *painter, const QVector<QPointF> &positions) const;
 
 protected:
   // property members:
@@ -305,6 +311,9 @@ protected:
   
   // non-property members:
   bool mPenDefined;
+  
+  // non-virtual methods:
+  QImage cachedGlyph(QCPPainter *painter, double devicePixelRatio, int &center) const;
 };
 Q_DECLARE_TYPEINFO(QCPScatterStyle, Q_MOVABLE_TYPE);
 
@@ -371,8 +380,19 @@ class QCP_LIB_DECL QCPLayer : public QObject
   Q_PROPERTY(int index READ index)
   Q_PROPERTY(QList<QCPLayerable*> children READ children)
   Q_PROPERTY(bool visible READ visible WRITE setVisible)
+  Q_PROPERTY(LayerMode mode READ mode WRITE setMode)
   /// \endcond
 public:
+  /*!
+    Defines how a layer is buffered during a replot.
+    
+    \see setMode, replot
+  */
+  enum LayerMode { lmLogical   ///< Layer is drawn into a paint buffer it shares with adjacent logical layers
+                   ,lmBuffered ///< Layer has its own paint buffer and can be redrawn on its own with \ref replot
+                 };
+  Q_ENUMS(LayerMode)
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -382,9 +402,14 @@ public:
   int index() const { return mIndex; }
   QList<QCPLayerable*> children() const { return mChildren; }
   bool visible() const { return mVisible; }
+  LayerMode mode() const { return mMode; }
   
   // setters:
   void setVisible(bool visible);
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  void replot();
   
 protected:
   // property members:
@@ -393,6 +418,10 @@ protected:
   int mIndex;
   QList<QCPLayerable*> mChildren;
   bool mVisible;
+  LayerMode mMode;
+  
+  // non-property members:
+  QImage mPaintBuffer;
   
   // non-virtual methods:
   void addChild(QCPLayerable *layerable, bool prepend);
@@ -597,6 +626,18 @@ inline const QCPRange operator/(const QCPRange& range, double value)
 }
 
 
+/*!
+  Linear mapping of coordinates to pixels, <tt>(coord-origin)*scale+offset</tt>. The origin is
+  subtracted before scaling so large coordinates in small ranges keep their precision.
+  
+  \see QCPAxis::getLinearTransform, QCPKernels::linearTransform
+*/
+struct QCPLinearTransform
+{
+  double origin, scale, offset;
+};
+
+
 class QCP_LIB_DECL QCPMarginGroup : public QObject
 {
   Q_OBJECT
@@ -1210,6 +1251,8 @@ public:
   void rescale(bool onlyVisiblePlottables=false);
   double pixelToCoord(double value) const;
   double coordToPixel(double value) const;
+  void coordsToPixels(const double *coords, double *pixels, int count) const;
+  bool getLinearTransform(QCPLinearTransform &transform) const;
   SelectablePart getPartAt(const QPointF &pos) const;
   QList<QCPAbstractPlottable*> plottables() const;
   QList<QCPGraph*> graphs() const;
@@ -1276,6 +1319,9 @@ protected:
   int mLowestVisibleTick, mHighestVisibleTick;
   QVector<double> mTickVector;
   QVector<QString> mTickVectorLabels;
+  QVector<double> mPreviousTickVector; // visible ticks of the last setupTickVectors call, to reuse their labels
+  QVector<QString> mPreviousTickVectorLabels;
+  QByteArray mPreviousLabelFormat;
   QVector<double> mSubTickVector;
   bool mCachedMarginValid;
   int mCachedMargin;
@@ -1373,6 +1419,11 @@ protected:
   QCustomPlot *mParentPlot;
   QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
   QCache<QString, CachedLabel> mLabelCache;
+  mutable QByteArray mLabelSizeParameterHash;
+  mutable QCache<QString, QSize> mLabelSizeCache; // sizes of tick labels measured for the margin calculation
+  mutable QString mCachedLabelText;
+  mutable QFont mCachedLabelFont;
+  mutable int mCachedLabelHeight;
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   
   virtual QByteArray generateLabelParameterHash() const;
@@ -1868,6 +1919,10 @@ protected:
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
+  QThreadPool *mRenderThreadPool;
+  QVector<QImage> mRenderBuffers;
+  QVector<QImage> mLogicalLayerBuffers;
+  bool mLayerBuffersValid;
   
   // reimplemented virtual methods:
   virtual QSize minimumSizeHint() const;
@@ -1889,6 +1944,12 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  void drawLayers(QCPPainter *painter, const QList<QCPLayer*> &layers);
+  void drawLayerable(QCPPainter *painter, QCPLayerable *layerable);
+  void drawLayerablesParallel(QCPPainter *painter, const QList<QCPLayerable*> &layerables);
+  bool hasBufferedLayers() const;
+  void drawBuffered(QCPPainter *painter, QCPLayer *onlyLayer);
+  void replotLayer(QCPLayer *layer);
   
   friend class QCPLegend;
   friend class QCPAxis;
@@ -2464,11 +2525,443 @@ private:
 
 
 
+/*! \class QCPKernels
+  \brief Vectorized kernels for the coordinate transform and decimation hot paths
+  
+  The kernels work on contiguous double arrays and are dispatched at runtime to AVX, SSE2 or plain
+  scalar code, depending on what the CPU supports. \ref setInstructionSet can force a lower
+  instruction set, e.g. to compare results against the scalar path.
+*/
+class QCP_LIB_DECL QCPKernels
+{
+public:
+  /*!
+    Defines the instruction set used by the kernels.
+  */
+  enum InstructionSet { isScalar ///< Plain C++
+                        ,isSse2  ///< SSE2, two doubles per instruction
+                        ,isAvx   ///< AVX, four doubles per instruction
+                      };
+  
+  static InstructionSet instructionSet();
+  static InstructionSet supportedInstructionSet();
+  static void setInstructionSet(InstructionSet instructionSet);
+  
+  static void linearTransform(const double *in, double *out, int count, const QCPLinearTransform &t);
+  static void linearTransformPairs(const double *in, int inStride, double *out, int count, const QCPLinearTransform &t0, const QCPLinearTransform &t1, bool swapped);
+  static void minMax(const double *values, int stride, int count, double &min, double &max);
+};
+
+
+namespace QCP
+{
+QCP_LIB_DECL quint64 nextDataRevision();
+}
+
+/*! \class QCPDataContainer
+  \brief Sorted, contiguous container for plottable data points
+  
+  Stores the data points of a plottable in a single QVector, sorted by their key. It offers the
+  subset of the QMap<double, T> interface that was used for the plottable data maps, so existing
+  code that uses \ref QCPDataMap and friends keeps working. Compared to a QMap, there is no heap
+  node per data point and iteration is cache friendly. Appending points in key order (the common
+  case) is amortized constant time, inserting in the middle is linear.
+  
+  The container is implicitly shared, copying it is cheap until one of the copies is modified.
+  
+  \a T must provide a \c sortKey() method that returns the key by which the points are sorted.
+  The key passed to \ref insertMulti and \ref insert must be equal to that sort key.
+  
+  Every modification, including writing through a mutable iterator, assigns a new \ref revision.
+  Revisions are unique across containers, so plottables can cache values derived from their data
+  (e.g. its bounds) and compare the revision to know when to recalculate them.
+*/
+template <class T>
+class QCPDataContainer
+{
+public:
+  class iterator;
+  
+  class const_iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef qptrdiff difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+    
+    const_iterator() : p(0) {}
+    explicit const_iterator(const T *ptr) : p(ptr) {}
+    
+    double key() const { return p->sortKey(); }
+    const T &value() const { return *p; }
+    const T &operator*() const { return *p; }
+    const T *operator->() const { return p; }
+    const T &operator[](int j) const { return p[j]; }
+    
+    bool operator==(const const_iterator &other) const { return p == other.p; }
+    bool operator!=(const const_iterator &other) const { return p != other.p; }
+    bool operator<(const const_iterator &other) const { return p < other.p; }
+    bool operator<=(const const_iterator &other) const { return p <= other.p; }
+    bool operator>(const const_iterator &other) const { return p > other.p; }
+    bool operator>=(const const_iterator &other) const { return p >= other.p; }
+    
+    const_iterator &operator++() { ++p; return *this; }
+    const_iterator operator++(int) { const_iterator r(*this); ++p; return r; }
+    const_iterator &operator--() { --p; return *this; }
+    const_iterator operator--(int) { const_iterator r(*this); --p; return r; }
+    const_iterator &operator+=(int j) { p += j; return *this; }
+    const_iterator &operator-=(int j) { p -= j; return *this; }
+    const_iterator operator+(int j) const { return const_iterator(p+j); }
+    const_iterator operator-(int j) const { return const_iterator(p-j); }
+    int operator-(const const_iterator &other) const { return int(p-other.p); }
+    
+  private:
+    const T *p;
+  };
+  
+  // refers to the container by index, so obtaining it doesn't detach; writing through it does
+  class iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef qptrdiff difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+    
+    iterator() : c(0), i(0) {}
+    iterator(QCPDataContainer *container, int index) : c(container), i(index) {}
+    
+    double key() const { return c->mData.at(i).sortKey(); }
+    T &value() const { c->touch(); return c->mData[i]; }
+    T &operator*() const { c->touch(); return c->mData[i]; }
+    T *operator->() const { c->touch(); return &c->mData[i]; }
+    T &operator[](int j) const { c->touch(); return c->mData[i+j]; }
+    operator const_iterator() const { return const_iterator(c->mData.constData()+i); }
+    
+    bool operator==(const iterator &other) const { return i == other.i; }
+    bool operator!=(const iterator &other) const { return i != other.i; }
+    bool operator<(const iterator &other) const { return i < other.i; }
+    bool operator<=(const iterator &other) const { return i <= other.i; }
+    bool operator>(const iterator &other) const { return i > other.i; }
+    bool operator>=(const iterator &other) const { return i >= other.i; }
+    
+    iterator &operator++() { ++i; return *this; }
+    iterator operator++(int) { iterator r(*this); ++i; return r; }
+    iterator &operator--() { --i; return *this; }
+    iterator operator--(int) { iterator r(*this); --i; return r; }
+    iterator &operator+=(int j) { i += j; return *this; }
+    iterator &operator-=(int j) { i -= j; return *this; }
+    iterator operator+(int j) const { return iterator(c, i+j); }
+    iterator operator-(int j) const { return iterator(c, i-j); }
+    int operator-(const iterator &other) const { return i-other.i; }
+    
+  private:
+    QCPDataContainer *c;
+    int i;
+    
+    friend class QCPDataContainer;
+  };
+  
+  QCPDataContainer() : mRevision(QCP::nextDataRevision()) {}
+  
+  // getters:
+  quint64 revision() const { return mRevision; }
+  int size() const { return mData.size(); }
+  int count() const { return mData.size(); }
+  bool isEmpty() const { return mData.isEmpty(); }
+  bool empty() const { return mData.isEmpty(); }
+  const T &first() const { return mData.first(); }
+  const T &last() const { return mData.last(); }
+  double firstKey() const { return mData.first().sortKey(); }
+  double lastKey() const { return mData.last().sortKey(); }
+  bool contains(double key) const { return find(key) != constEnd(); }
+  T value(double key, const T &defaultValue=T()) const;
+  QList<double> keys() const;
+  QList<T> values() const;
+  
+  // iterators:
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, mData.size()); }
+  const_iterator begin() const { return constBegin(); }
+  const_iterator end() const { return constEnd(); }
+  const_iterator constBegin() const { return const_iterator(mData.constData()); }
+  const_iterator constEnd() const { return const_iterator(mData.constData()+mData.size()); }
+  iterator lowerBound(double key) { return iterator(this, constLowerBound(key)-constBegin()); }
+  iterator upperBound(double key) { return iterator(this, constUpperBound(key)-constBegin()); }
+  const_iterator lowerBound(double key) const { return constLowerBound(key); }
+  const_iterator upperBound(double key) const { return constUpperBound(key); }
+  iterator find(double key);
+  const_iterator find(double key) const;
+  
+  // non-property methods:
+  void clear() { mData.clear(); touch(); }
+  void reserve(int size) { mData.reserve(size); }
+  void squeeze() { mData.squeeze(); }
+  iterator insertMulti(double key, const T &value);
+  iterator insert(double key, const T &value);
+  QCPDataContainer &unite(const QCPDataContainer &other);
+  iterator erase(iterator it) { return erase(it, it+1); }
+  iterator erase(iterator first, iterator last);
+  int remove(double key);
+  
+private:
+  QVector<T> mData;
+  quint64 mRevision;
+  
+  void touch() { mRevision = QCP::nextDataRevision(); }
+  const_iterator constLowerBound(double key) const;
+  const_iterator constUpperBound(double key) const;
+};
+
+template <class T>
+T QCPDataContainer<T>::value(double key, const T &defaultValue) const
+{
+  const_iterator it = find(key);
+  return it != constEnd() ? *it : defaultValue;
+}
+
+template <class T>
+QList<double> QCPDataContainer<T>::keys() const
+{
+  QList<double> result;
+  result.reserve(mData.size());
+  for (const_iterator it = constBegin(); it != constEnd(); ++it)
+    result.append(it.key());
+  return result;
+}
+
+template <class T>
+QList<T> QCPDataContainer<T>::values() const
+{
+  QList<T> result;
+  result.reserve(mData.size());
+  for (const_iterator it = constBegin(); it != constEnd(); ++it)
+    result.append(*it);
+  return result;
+}
+
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::find(double key)
+{
+  const_iterator it = static_cast<const QCPDataContainer&>(*this).find(key);
+  return iterator(this, it-constBegin());
+}
+
+template <class T>
+typename QCPDataContainer<T>::const_iterator QCPDataContainer<T>::find(double key) const
+{
+  const_iterator it = constLowerBound(key);
+  return it != constEnd() && !(key < it.key()) ? it : constEnd();
+}
+
+/*!
+  Inserts \a value at the position of \a key, after any existing points with the same key. If \a
+  key is not smaller than the last key in the container, the point is appended without moving
+  other points.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::insertMulti(double key, const T &value)
+{
+  touch();
+  if (mData.isEmpty() || !(key < mData.last().sortKey()))
+  {
+    mData.append(value);
+    return iterator(this, mData.size()-1);
+  }
+  int index = constUpperBound(key)-constBegin();
+  mData.insert(index, value);
+  return iterator(this, index);
+}
+
+/*!
+  Inserts \a value at the position of \a key. If a point with the same key already exists, it is
+  replaced by \a value.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::insert(double key, const T &value)
+{
+  touch();
+  int index = constLowerBound(key)-constBegin();
+  if (index < mData.size() && !(key < mData.at(index).sortKey()))
+    mData[index] = value;
+  else
+    mData.insert(index, value);
+  return iterator(this, index);
+}
+
+/*!
+  Adds all points of \a other. If all points of \a other come after the points in this container,
+  they are appended, otherwise both sorted ranges are merged.
+*/
+template <class T>
+QCPDataContainer<T> &QCPDataContainer<T>::unite(const QCPDataContainer &other)
+{
+  if (other.isEmpty())
+    return *this;
+  touch();
+  if (isEmpty())
+  {
+    mData = other.mData;
+  } else if (!(other.firstKey() < lastKey()))
+  {
+    mData += other.mData;
+  } else
+  {
+    QVector<T> merged;
+    merged.reserve(mData.size()+other.mData.size());
+    const_iterator a = constBegin(), b = other.constBegin();
+    while (a != constEnd() && b != other.constEnd())
+    {
+      if (b.key() < a.key())
+        merged.append(*b++);
+      else
+        merged.append(*a++);
+    }
+    for (; a != constEnd(); ++a)
+      merged.append(*a);
+    for (; b != other.constEnd(); ++b)
+      merged.append(*b);
+    mData.swap(merged);
+  }
+  return *this;
+}
+
+/*!
+  Removes the points in the range [\a first, \a last) and returns an iterator to the point after
+  the removed range. Unlike repeated single erases, this moves the remaining points only once.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::erase(iterator first, iterator last)
+{
+  if (first.i < last.i)
+  {
+    mData.remove(first.i, last.i-first.i);
+    touch();
+  }
+  return iterator(this, first.i);
+}
+
+/*!
+  Removes all points with \a key and returns the number of removed points.
+*/
+template <class T>
+int QCPDataContainer<T>::remove(double key)
+{
+  iterator first = lowerBound(key);
+  iterator last = upperBound(key);
+  erase(first, last);
+  return last.i-first.i;
+}
+
+template <class T>
+typename QCPDataContainer<T>::const_iterator QCPDataContainer<T>::constLowerBound(double key) const
+{
+  // first point with key >= key
+  const T *lo = mData.constData();
+  int count = mData.size();
+  while (count > 0)
+  {
+    int half = count/2;
+    if (lo[half].sortKey() < key)
+    {
+      lo += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return const_iterator(lo);
+}
+
+template <class T>
+typename QCPDataContainer<T>::const_iterator QCPDataContainer<T>::constUpperBound(double key) const
+{
+  // first point with key > key
+  const T *lo = mData.constData();
+  int count = mData.size();
+  while (count > 0)
+  {
+    int half = count/2;
+    if (!(key < lo[half].sortKey()))
+    {
+      lo += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return const_iterator(lo);
+}
+
+
+/*! \class QCPDataContainerIterator
+  \brief Java-style const iterator for \ref QCPDataContainer, with the interface of QMapIterator
+*/
+template <class T>
+class QCPDataContainerIterator
+{
+public:
+  typedef typename QCPDataContainer<T>::const_iterator const_iterator;
+  
+  QCPDataContainerIterator(const QCPDataContainer<T> &container) : c(container), i(c.constBegin()), n(c.constEnd()) {}
+  
+  void toFront() { i = c.constBegin(); n = c.constEnd(); }
+  void toBack() { i = c.constEnd(); n = c.constEnd(); }
+  bool hasNext() const { return i != c.constEnd(); }
+  const_iterator next() { n = i++; return n; }
+  const_iterator peekNext() const { return i; }
+  bool hasPrevious() const { return i != c.constBegin(); }
+  const_iterator previous() { n = --i; return n; }
+  const_iterator peekPrevious() const { return i-1; }
+  double key() const { return n.key(); }
+  const T &value() const { return n.value(); }
+  
+private:
+  QCPDataContainer<T> c; // implicitly shared copy, like QMapIterator
+  const_iterator i, n;
+};
+
+/*! \class QCPDataContainerMutableIterator
+  \brief Java-style non-const iterator for \ref QCPDataContainer, with the interface of QMutableMapIterator
+*/
+template <class T>
+class QCPDataContainerMutableIterator
+{
+public:
+  typedef typename QCPDataContainer<T>::iterator iterator;
+  
+  QCPDataContainerMutableIterator(QCPDataContainer<T> &container) : c(&container), i(c->begin()), n(c->end()) {}
+  
+  void toFront() { i = c->begin(); n = c->end(); }
+  void toBack() { i = c->end(); n = c->end(); }
+  bool hasNext() const { return i != c->end(); }
+  iterator next() { n = i++; return n; }
+  iterator peekNext() const { return i; }
+  bool hasPrevious() const { return i != c->begin(); }
+  iterator previous() { n = --i; return n; }
+  iterator peekPrevious() const { return i-1; }
+  void remove() { if (n != c->end()) { i = c->erase(n); n = c->end(); } }
+  void setValue(const T &value) const { if (n != c->end()) *n = value; }
+  double key() const { return n.key(); }
+  T &value() const { return n.value(); }
+  
+private:
+  QCPDataContainer<T> *c;
+  iterator i, n;
+};
+
+
+/*! \file */
+
+
+
 class QCP_LIB_DECL QCPData
 {
 public:
   QCPData();
   QCPData(double key, double value);
+  double sortKey() const { return key; }
   double key, value;
   double keyErrorPlus, keyErrorMinus;
   double valueErrorPlus, valueErrorMinus;
@@ -2480,11 +2973,11 @@ Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
   is the key member of the QCPData instance.
   
   This is the container in which QCPGraph holds its data.
-  \see QCPData, QCPGraph::setData
+  \see QCPData, QCPDataContainer, QCPGraph::setData
 */
-typedef QMap<double, QCPData> QCPDataMap;
-typedef QMapIterator<double, QCPData> QCPDataMapIterator;
-typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
+typedef QCPDataContainer<QCPData> QCPDataMap;
+typedef QCPDataContainerIterator<QCPData> QCPDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPData> QCPDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
@@ -2589,6 +3082,16 @@ protected:
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  struct CachedRange
+  {
+    CachedRange() : revision(0), foundRange(false) {}
+    quint64 revision;
+    bool foundRange;
+    QCPRange range;
+  };
+  mutable CachedRange mKeyRangeCache[6], mValueRangeCache[6]; // indexed by cachedRangeIndex
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
@@ -2615,6 +3118,9 @@ protected:
   void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
   void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const;
   int countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const;
+  QCPRange calcKeyRange(QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const;
+  QCPRange calcValueRange(QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const;
+  void extendCachedRanges(quint64 previousRevision, QCPDataMap::const_iterator begin, QCPDataMap::const_iterator end) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -2625,6 +3131,92 @@ protected:
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint) const;
+  void mergeCachedRange(CachedRange &cached, const QCPRange &range, bool found) const;
+  static int cachedRangeIndex(SignDomain inSignDomain, bool includeErrors);
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
+
+/*! \file */
+
+
+
+class QCP_LIB_DECL QCPCompactData
+{
+public:
+  QCPCompactData();
+  QCPCompactData(double key, double value);
+  double sortKey() const { return key; }
+  float key, value;
+};
+Q_DECLARE_TYPEINFO(QCPCompactData, Q_PRIMITIVE_TYPE);
+
+/*! \typedef QCPCompactDataMap
+  Container for storing \ref QCPCompactData points in a sorted fashion. The key of the map is the
+  key member of the QCPCompactData instance.
+  
+  This is the container in which QCPCompactGraph holds its data.
+  \see QCPCompactData, QCPCompactGraph::setData
+*/
+typedef QCPDataContainer<QCPCompactData> QCPCompactDataMap;
+
+
+class QCP_LIB_DECL QCPCompactGraph : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
+  /// \endcond
+public:
+  explicit QCPCompactGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPCompactGraph();
+  
+  // getters:
+  QCPCompactDataMap *data() const { return mData; }
+  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  
+  // setters:
+  void setData(const QCPCompactDataMap &data);
+  void setData(const QVector<double> &key, const QVector<double> &value);
+  void setScatterStyle(const QCPScatterStyle &style);
+  
+  // non-property methods:
+  void addData(double key, double value);
+  void addData(const QVector<double> &keys, const QVector<double> &values);
+  void removeDataBefore(double key);
+  void removeDataAfter(double key);
+  
+  // reimplemented virtual methods:
+  virtual void clearData();
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
+  
+protected:
+  // property members:
+  QCPCompactDataMap *mData;
+  QCPScatterStyle mScatterStyle;
+  
+  // non-property members:
+  struct CachedRange
+  {
+    CachedRange() : revision(0), foundRange(false) {}
+    quint64 revision;
+    bool foundRange;
+    QCPRange range;
+  };
+  mutable CachedRange mKeyRangeCache[3], mValueRangeCache[3]; // indexed by sign domain
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter);
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
+  virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  
+  // non-virtual methods:
+  bool getLinePlotData(QVector<QPointF> *linePixelData) const;
+  void getVisibleDataBounds(QCPCompactDataMap::const_iterator &begin, QCPCompactDataMap::const_iterator &end) const;
+  QCPRange calcRange(bool keyRange, bool &foundRange, SignDomain inSignDomain) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -2640,6 +3232,7 @@ class QCP_LIB_DECL QCPCurveData
 public:
   QCPCurveData();
   QCPCurveData(double t, double key, double value);
+  double sortKey() const { return t; }
   double t, key, value;
 };
 Q_DECLARE_TYPEINFO(QCPCurveData, Q_MOVABLE_TYPE);
@@ -2649,12 +3242,12 @@ Q_DECLARE_TYPEINFO(QCPCurveData, Q_MOVABLE_TYPE);
   is the t member of the QCPCurveData instance.
   
   This is the container in which QCPCurve holds its data.
-  \see QCPCurveData, QCPCurve::setData
+  \see QCPCurveData, QCPDataContainer, QCPCurve::setData
 */
 
-typedef QMap<double, QCPCurveData> QCPCurveDataMap;
-typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
-typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
+typedef QCPDataContainer<QCPCurveData> QCPCurveDataMap;
+typedef QCPDataContainerIterator<QCPCurveData> QCPCurveDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPCurveData> QCPCurveDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
@@ -2708,6 +3301,9 @@ protected:
   QCPCurveDataMap *mData;
   QCPScatterStyle mScatterStyle;
   LineStyle mLineStyle;
+  // non-property members:
+  mutable quint64 mKeysAscendingRevision;
+  mutable bool mKeysAscending;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
@@ -2720,6 +3316,7 @@ protected:
   
   // non-virtual methods:
   void getCurveData(QVector<QPointF> *lineData) const;
+  bool keysAscending() const;
   int getRegion(double x, double y, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QPointF getOptimizedPoint(int prevRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QVector<QPointF> getOptimizedCornerPoints(int prevRegion, int currentRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
@@ -2804,6 +3401,7 @@ class QCP_LIB_DECL QCPBarData
 public:
   QCPBarData();
   QCPBarData(double key, double value);
+  double sortKey() const { return key; }
   double key, value;
 };
 Q_DECLARE_TYPEINFO(QCPBarData, Q_MOVABLE_TYPE);
@@ -2813,11 +3411,11 @@ Q_DECLARE_TYPEINFO(QCPBarData, Q_MOVABLE_TYPE);
   is the key member of the QCPBarData instance.
   
   This is the container in which QCPBars holds its data.
-  \see QCPBarData, QCPBars::setData
+  \see QCPBarData, QCPDataContainer, QCPBars::setData
 */
-typedef QMap<double, QCPBarData> QCPBarDataMap;
-typedef QMapIterator<double, QCPBarData> QCPBarDataMapIterator;
-typedef QMutableMapIterator<double, QCPBarData> QCPBarDataMutableMapIterator;
+typedef QCPDataContainer<QCPBarData> QCPBarDataMap;
+typedef QCPDataContainerIterator<QCPBarData> QCPBarDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPBarData> QCPBarDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPBars : public QCPAbstractPlottable
@@ -3038,6 +3636,13 @@ protected:
   double *mData;
   QCPRange mDataBounds;
   bool mDataModified;
+  QBitArray mModifiedTiles;
+  
+  // non-virtual methods:
+  int keyTileCount() const;
+  int valueTileCount() const;
+  void setCellModified(int keyIndex, int valueIndex);
+  void setAllModified();
   
   friend class QCPColorMap;
 };
@@ -3102,6 +3707,7 @@ protected:
   QImage mMapImage, mUndersampledMapImage;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  Qt::Orientation mMapImageKeyOrientation;
   
   // introduced virtual methods:
   virtual void updateMapImage();
@@ -3126,6 +3732,7 @@ class QCP_LIB_DECL QCPFinancialData
 public:
   QCPFinancialData();
   QCPFinancialData(double key, double open, double high, double low, double close);
+  double sortKey() const { return key; }
   double key, open, high, low, close;
 };
 Q_DECLARE_TYPEINFO(QCPFinancialData, Q_MOVABLE_TYPE);
@@ -3135,11 +3742,11 @@ Q_DECLARE_TYPEINFO(QCPFinancialData, Q_MOVABLE_TYPE);
   is the key member of the QCPFinancialData instance.
   
   This is the container in which QCPFinancial holds its data.
-  \see QCPFinancial, QCPFinancial::setData
+  \see QCPFinancial, QCPDataContainer, QCPFinancial::setData
 */
-typedef QMap<double, QCPFinancialData> QCPFinancialDataMap;
-typedef QMapIterator<double, QCPFinancialData> QCPFinancialDataMapIterator;
-typedef QMutableMapIterator<double, QCPFinancialData> QCPFinancialDataMutableMapIterator;
+typedef QCPDataContainer<QCPFinancialData> QCPFinancialDataMap;
+typedef QCPDataContainerIterator<QCPFinancialData> QCPFinancialDataMapIterator;
+typedef QCPDataContainerMutableIterator<QCPFinancialData> QCPFinancialDataMutableMapIterator;
 
 
 class QCP_LIB_DECL QCPFinancial : public QCPAbstractPlottable
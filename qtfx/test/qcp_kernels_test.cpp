@@ -0,0 +1,164 @@
+// checks that the SSE2 and AVX paths of QCPKernels produce bit-identical results to the scalar path
+
+#include "qcustomplot/qcustomplot.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int maxCount = 17;
+	const int maxHead = 3; // start offsets in doubles, so both aligned and unaligned loads are covered
+	const int repeats = 200;
+
+	const QCPKernels::InstructionSet instructionSets[] = { QCPKernels::isScalar, QCPKernels::isSse2, QCPKernels::isAvx };
+	const char* instructionSetNames[] = { "scalar", "sse2", "avx" };
+
+	int failures = 0;
+
+	std::vector< double > randomValues( std::mt19937& rng, int size )
+	{
+		std::uniform_real_distribution< double > value( -1e6, 1e6 );
+		std::uniform_int_distribution< int > special( 0, 9 );
+		std::vector< double > v( size );
+		for ( auto& x : v )
+		{
+			switch ( special( rng ) )
+			{
+			case 0: x = std::numeric_limits< double >::quiet_NaN(); break;
+			case 1: x = 1e9 + value( rng ) * 1e-6; break; // large coordinates in a small range
+			default: x = value( rng );
+			}
+		}
+		return v;
+	}
+
+	// NaN aware exact comparison
+	bool sameBits( const double* a, const double* b, int count )
+	{
+		return count == 0 || std::memcmp( a, b, count * sizeof( double ) ) == 0;
+	}
+
+	void check( bool ok, const char* kernel, int set, int head, int count, int stride )
+	{
+		if ( !ok )
+		{
+			std::printf( "FAILED: %s %s head=%d count=%d stride=%d\n", kernel, instructionSetNames[ set ], head, count, stride );
+			++failures;
+		}
+	}
+
+	void testLinearTransform( std::mt19937& rng )
+	{
+		const QCPLinearTransform transform{ 1e9, -0.37, 412.5 };
+		for ( int r = 0; r < repeats; ++r )
+		{
+			for ( int count = 0; count <= maxCount; ++count )
+			{
+				for ( int head = 0; head <= maxHead; ++head )
+				{
+					auto in = randomValues( rng, head + count + maxHead );
+					std::vector< double > expected( head + count + maxHead, 0.0 );
+					QCPKernels::setInstructionSet( QCPKernels::isScalar );
+					QCPKernels::linearTransform( in.data() + head, expected.data() + head, count, transform );
+
+					for ( int set = 1; set < 3; ++set )
+					{
+						if ( instructionSets[ set ] > QCPKernels::supportedInstructionSet() )
+							continue;
+						std::vector< double > out( expected.size(), 0.0 );
+						QCPKernels::setInstructionSet( instructionSets[ set ] );
+						QCPKernels::linearTransform( in.data() + head, out.data() + head, count, transform );
+						// also verifies that nothing is written outside [head, head + count)
+						check( sameBits( out.data(), expected.data(), int( out.size() ) ), "linearTransform", set, head, count, 1 );
+					}
+				}
+			}
+		}
+	}
+
+	void testLinearTransformPairs( std::mt19937& rng )
+	{
+		const QCPLinearTransform t0{ 1e9, 0.25, 10.0 }, t1{ -3.0, -1.5, 300.0 };
+		for ( int r = 0; r < repeats; ++r )
+		{
+			for ( int count = 0; count <= maxCount; ++count )
+			{
+				for ( int stride = 2; stride <= 3; ++stride )
+				{
+					for ( int swapped = 0; swapped <= 1; ++swapped )
+					{
+						const int head = r % ( maxHead + 1 );
+						auto in = randomValues( rng, head + count * stride + 2 );
+						std::vector< double > expected( 2 * count + maxHead, 0.0 );
+						QCPKernels::setInstructionSet( QCPKernels::isScalar );
+						QCPKernels::linearTransformPairs( in.data() + head, stride, expected.data() + 1, count, t0, t1, swapped != 0 );
+
+						for ( int set = 1; set < 3; ++set )
+						{
+							if ( instructionSets[ set ] > QCPKernels::supportedInstructionSet() )
+								continue;
+							std::vector< double > out( expected.size(), 0.0 );
+							QCPKernels::setInstructionSet( instructionSets[ set ] );
+							QCPKernels::linearTransformPairs( in.data() + head, stride, out.data() + 1, count, t0, t1, swapped != 0 );
+							check( sameBits( out.data(), expected.data(), int( out.size() ) ), "linearTransformPairs", set, head, count, stride );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void testMinMax( std::mt19937& rng )
+	{
+		for ( int r = 0; r < repeats; ++r )
+		{
+			for ( int count = 1; count <= maxCount; ++count )
+			{
+				for ( int stride = 1; stride <= 2; ++stride )
+				{
+					for ( int head = 0; head <= maxHead; ++head )
+					{
+						auto in = randomValues( rng, head + count * stride );
+						double expected[ 2 ];
+						QCPKernels::setInstructionSet( QCPKernels::isScalar );
+						QCPKernels::minMax( in.data() + head, stride, count, expected[ 0 ], expected[ 1 ] );
+
+						for ( int set = 1; set < 3; ++set )
+						{
+							if ( instructionSets[ set ] > QCPKernels::supportedInstructionSet() )
+								continue;
+							double result[ 2 ];
+							QCPKernels::setInstructionSet( instructionSets[ set ] );
+							QCPKernels::minMax( in.data() + head, stride, count, result[ 0 ], result[ 1 ] );
+							check( sameBits( result, expected, 2 ), "minMax", set, head, count, stride );
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+int main()
+{
+	const auto supported = QCPKernels::supportedInstructionSet();
+	for ( int set = 1; set < 3; ++set )
+		if ( instructionSets[ set ] > supported )
+			std::printf( "skipping %s, not supported by this CPU or build\n", instructionSetNames[ set ] );
+
+	std::mt19937 rng( 12345 );
+	testLinearTransform( rng );
+	testLinearTransformPairs( rng );
+	testMinMax( rng );
+	QCPKernels::setInstructionSet( supported );
+
+	if ( failures > 0 )
+		std::printf( "%d failures\n", failures );
+	else std::printf( "all kernels match the scalar path\n" );
+	return failures > 0 ? 1 : 0;
+}